@@ -16,6 +16,9 @@ PERFORMANCE OF THIS SOFTWARE.
 #ifndef CLOWNLZSS_BITFIELD_H
 #define CLOWNLZSS_BITFIELD_H
 
+#include <algorithm>
+#include <array>
+
 #include "common.h"
 
 namespace ClownLZSS
@@ -51,6 +54,35 @@ namespace ClownLZSS
 			// TODO: Delete this.
 			using Endian = Internal::Endian;
 
+			inline constexpr auto reversed_bytes = []() constexpr
+			{
+				std::array<unsigned char, 0x100> table{};
+
+				for (unsigned int i = 0; i < table.size(); ++i)
+					for (unsigned int j = 0; j < 8; ++j)
+						if ((i & 1 << j) != 0)
+							table[i] |= 1 << (8 - j - 1);
+
+				return table;
+			}();
+
+			// Bits are popped and pushed in groups, but each group is stored in the opposite order when popping
+			// from the low end or pushing to the high end.
+			constexpr unsigned long long ReverseBits(const unsigned long long value, const unsigned int total_bits)
+			{
+				const unsigned long long reversed = static_cast<unsigned long long>(reversed_bytes[value >> 0 & 0xFF]) << 24
+				                                  | static_cast<unsigned long long>(reversed_bytes[value >> 8 & 0xFF]) << 16
+				                                  | static_cast<unsigned long long>(reversed_bytes[value >> 16 & 0xFF]) << 8
+				                                  | static_cast<unsigned long long>(reversed_bytes[value >> 24 & 0xFF]) << 0;
+
+				return reversed >> (32 - total_bits);
+			}
+
+			constexpr unsigned long long BitMask(const unsigned int total_bits)
+			{
+				return (1ull << total_bits) - 1;
+			}
+
 			template<unsigned int total_bytes, ReadWhen read_when, PopWhere pop_where, Endian endian, typename Input>
 			requires (total_bytes >= 1) && (total_bytes <= 4)
 			class Reader
@@ -59,7 +91,7 @@ namespace ClownLZSS
 				static constexpr unsigned int total_bits = total_bytes * 8;
 
 				Input &input;
-				unsigned long bits = 0;
+				unsigned long long bits = 0;
 				unsigned int bits_remaining;
 
 				void ReadBits()
@@ -68,6 +100,27 @@ namespace ClownLZSS
 					bits = input.template Read<total_bytes, endian>();
 				};
 
+				// Pops bits which are all in the current descriptor field.
+				unsigned long long PopFromField(const unsigned int total)
+				{
+					unsigned long long value;
+
+					if constexpr(pop_where == PopWhere::High)
+					{
+						value = bits >> (total_bits - total) & BitMask(total);
+						bits <<= total;
+					}
+					else if constexpr(pop_where == PopWhere::Low)
+					{
+						value = ReverseBits(bits & BitMask(total), total);
+						bits >>= total;
+					}
+
+					bits_remaining -= total;
+
+					return value;
+				}
+
 			public:
 				Reader(Input &input)
 					: input(input)
@@ -109,20 +162,108 @@ namespace ClownLZSS
 					return bit;
 				}
 
-				unsigned int Pop(const unsigned int total_bits)
+				unsigned int Pop(unsigned int total)
 				{
-					unsigned int value = 0;
+					unsigned long long value = 0;
 
-					for (unsigned int i = 0; i < total_bits; ++i)
+					// Descriptor fields are still read one at a time, and at the same points as when popping
+					// individual bits, as many formats interleave them with other data.
+					while (total != 0)
 					{
-						value <<= 1;
-						value |= Pop();
+						if constexpr(read_when == ReadWhen::BeforePop)
+						{
+							if (bits_remaining == 0)
+								ReadBits();
+						}
+
+						const unsigned int bits_to_pop = std::min(total, bits_remaining);
+
+						value <<= bits_to_pop;
+						value |= PopFromField(bits_to_pop);
+						total -= bits_to_pop;
+
+						if constexpr(read_when == ReadWhen::AfterPop)
+						{
+							if (bits_remaining == 0)
+								ReadBits();
+						}
 					}
 
 					return value;
 				}
+
+				// Returns the next 'width' bits without popping them, in the order that they are stored in the
+				// descriptor field, along with how many of them belong to the current field. Bits past the end of
+				// the field read as 0, as the next field cannot be read early without disturbing the input.
+				template<unsigned int width>
+				requires (width <= total_bits)
+				unsigned int Peek(unsigned int &available)
+				{
+					if constexpr(read_when == ReadWhen::BeforePop)
+					{
+						if (bits_remaining == 0)
+							ReadBits();
+					}
+
+					available = std::min(bits_remaining, width);
+
+					if constexpr(pop_where == PopWhere::High)
+						return bits >> (total_bits - width) & BitMask(width);
+					else if constexpr(pop_where == PopWhere::Low)
+						return bits & BitMask(width);
+				}
+
+				// Pops bits that have already been examined with 'Peek'.
+				void Skip(const unsigned int total)
+				{
+					if constexpr(pop_where == PopWhere::High)
+						bits <<= total;
+					else if constexpr(pop_where == PopWhere::Low)
+						bits >>= total;
+
+					bits_remaining -= total;
+
+					if constexpr(read_when == ReadWhen::AfterPop)
+					{
+						if (bits_remaining == 0)
+							ReadBits();
+					}
+				}
 			};
 
+			// Produces a table for decoding a whole token from the result of 'Reader::Peek', instead of popping its
+			// bits one at a time. 'decode_token' follows the format's rules to decode a token using the function that
+			// it is passed to pop each bit, and the number of bits that it pops is recorded in the token's 'total_bits'.
+			// Tokens that are longer than 'width' are given a 'total_bits' that 'Peek' can never satisfy.
+			template<unsigned int width, PopWhere pop_where, typename Token, typename Callback>
+			constexpr std::array<Token, 1 << width> MakeTokenTable(const Callback &decode_token)
+			{
+				std::array<Token, 1 << width> table{};
+
+				for (unsigned int i = 0; i < table.size(); ++i)
+				{
+					unsigned int total_bits = 0;
+
+					const auto pop = [&]() constexpr
+					{
+						const unsigned int index = total_bits++;
+
+						if (index >= width)
+							return false;
+
+						if constexpr(pop_where == PopWhere::High)
+							return (i & 1 << (width - 1 - index)) != 0;
+						else //if constexpr(pop_where == PopWhere::Low)
+							return (i & 1 << index) != 0;
+					};
+
+					table[i] = decode_token(pop);
+					table[i].total_bits = total_bits;
+				}
+
+				return table;
+			}
+
 			template<unsigned int total_bytes, WriteWhen write_when, PushWhere push_where, Endian endian, typename Output, typename Derived>
 			requires (total_bytes >= 1) && (total_bytes <= 4)
 			class WriterBase
@@ -131,7 +272,7 @@ namespace ClownLZSS
 				static constexpr unsigned int total_bits = total_bytes * 8;
 
 				Output &output;
-				unsigned long bits = 0;
+				unsigned long long bits = 0;
 				unsigned int bits_remaining = total_bits;
 
 				void WriteBitsImplementation()
@@ -184,7 +325,7 @@ namespace ClownLZSS
 					if constexpr(push_where == PushWhere::High)
 					{
 						bits >>= 1;
-						bits |= bit << (total_bits - 1);
+						bits |= static_cast<unsigned long long>(bit) << (total_bits - 1);
 					}
 					else //if constexpr(push_where == PushWhere::Low)
 					{
@@ -198,10 +339,43 @@ namespace ClownLZSS
 						CheckWriteBits();
 				}
 
-				void Push(const unsigned int value, const unsigned int total_bits)
+				void Push(const unsigned int value, unsigned int total)
 				{
-					for (unsigned int i = 0; i < total_bits; ++i)
-						Push((value & 1 << (total_bits - i - 1)) != 0);
+					const auto &CheckWriteBits = [&]()
+					{
+						if (bits_remaining == 0)
+						{
+							WriteBits();
+						}
+					};
+
+					while (total != 0)
+					{
+						if constexpr(write_when == WriteWhen::BeforePush)
+							CheckWriteBits();
+
+						const unsigned int bits_to_push = std::min(total, bits_remaining);
+
+						total -= bits_to_push;
+
+						const unsigned long long bits_to_insert = static_cast<unsigned long long>(value) >> total & BitMask(bits_to_push);
+
+						if constexpr(push_where == PushWhere::High)
+						{
+							bits >>= bits_to_push;
+							bits |= ReverseBits(bits_to_insert, bits_to_push) << (total_bits - bits_to_push);
+						}
+						else //if constexpr(push_where == PushWhere::Low)
+						{
+							bits <<= bits_to_push;
+							bits |= bits_to_insert;
+						}
+
+						bits_remaining -= bits_to_push;
+
+						if constexpr(write_when == WriteWhen::AfterPush)
+							CheckWriteBits();
+					}
 				}
 			};
 
@@ -214,60 +388,72 @@ namespace ClownLZSS
 				{}
 			};
 
+			// Many formats interleave their descriptor fields with the data that they describe, with each field
+			// preceding its data. Rather than insert a placeholder and seek back to it once the field is complete,
+			// this holds onto the data until then, so that everything can be written in order without seeking.
+			// As a result, the data must be written through this object rather than directly to the output,
+			// and 'Finish' must be called once everything has been written, to output the final field.
 			template<unsigned int total_bytes, WriteWhen write_when, PushWhere push_where, Endian endian, typename Output>
-			class DescriptorFieldWriter : public WriterBase<total_bytes, write_when, push_where, endian, Output, DescriptorFieldWriter<total_bytes, write_when, push_where, endian, Output>>
+			class DescriptorFieldWriter : public WriterBase<total_bytes, write_when, push_where, endian, Output, DescriptorFieldWriter<total_bytes, write_when, push_where, endian, Output>>, public OutputCommonBase<DescriptorFieldWriter<total_bytes, write_when, push_where, endian, Output>>
 			{
 			protected:
 				using Base = WriterBase<total_bytes, write_when, push_where, endian, Output, DescriptorFieldWriter<total_bytes, write_when, push_where, endian, Output>>;
+				using OutputBase = OutputCommonBase<DescriptorFieldWriter<total_bytes, write_when, push_where, endian, Output>>;
 
 				using Base::output;
+				using Base::total_bits;
+				using Base::bits_remaining;
 
-				typename std::remove_cvref_t<Output>::pos_type descriptor_position;
+				// No format stores more than a few bytes of data per descriptor bit.
+				std::array<unsigned char, total_bits * 4> data;
+				unsigned int data_size = 0;
+				bool overflowed = false;
 
-				void Begin()
+				void WriteData()
 				{
-					// Log the placement of the descriptor field.
-					descriptor_position = output.Tell();
+					for (unsigned int i = 0; i < data_size; ++i)
+						output.Write(data[i]);
 
-					// Insert a placeholder.
-					output.Fill(0, total_bytes);
+					data_size = 0;
 				}
 
-				template<typename T>
-				void Finish(T &&function)
+				void WriteImplementation(const unsigned char value)
 				{
-					// Back up current position.
-					const auto current_position = output.Tell();
-
-					// Go back to the descriptor field.
-					output.Seek(descriptor_position);
-
-					// Write the complete descriptor field.
-					function();
-
-					// Seek back to where we were before.
-					output.Seek(current_position);
+					// Data which does not fit is dropped, and the failure is reported by 'Finish'.
+					if (data_size == data.size())
+						overflowed = true;
+					else
+						data[data_size++] = value;
 				}
 
 				void WriteBitsImplementation()
 				{
-					Finish([this](){Base::WriteBitsImplementation();});
-					Begin();
+					Base::WriteBitsImplementation();
+					WriteData();
 				}
 
 			public:
 				DescriptorFieldWriter(Output &output)
 					: Base::WriterBase(output)
-				{
-					Begin();
-				}
+				{}
 
-				~DescriptorFieldWriter()
+				// Writes the final descriptor field and its data. Returns false if a descriptor field
+				// had more data than could be held onto, in which case the output is incomplete.
+				bool Finish()
 				{
-					Finish([this](){Base::Flush();});
+					// Even an empty descriptor field gets written, as decompressors may expect one to be there.
+					if (bits_remaining == total_bits)
+						output.template Write<total_bytes, endian>(0);
+					else
+						Base::Flush();
+
+					WriteData();
+
+					return !overflowed;
 				}
 
 				friend Base;
+				friend OutputBase;
 			};
 		}
 	}
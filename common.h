@@ -16,8 +16,12 @@ PERFORMANCE OF THIS SOFTWARE.
 #ifndef CLOWNLZSS_COMMON_H
 #define CLOWNLZSS_COMMON_H
 
+#include <algorithm>
+#include <cstddef>
 #include <iterator>
 #if __STDC_HOSTED__
+	#include <array>
+	#include <exception>
 	#include <ostream>
 #endif
 #include <type_traits>
@@ -32,6 +36,10 @@ namespace ClownLZSS
 			Little
 		};
 
+		// Passing this as the output type produces an output that only counts how many bytes are written to it,
+		// for learning how large some data will be without producing it.
+		struct Discard {};
+
 		template<typename T>
 		concept random_access_input_output_iterator = std::random_access_iterator<T> && std::output_iterator<T, unsigned char>;
 
@@ -75,12 +83,41 @@ namespace ClownLZSS
 		template<typename Derived>
 		class InputCommon
 		{
+		protected:
+			void FinishImplementation()
+			{}
+
+			template<typename OutputIterator>
+			OutputIterator ReadBlockImplementation(OutputIterator destination, const std::size_t count)
+			{
+				for (std::size_t i = 0; i < count; ++i)
+				{
+					*destination = Read();
+					++destination;
+				}
+
+				return destination;
+			}
+
 		public:
 			unsigned char Read()
 			{
 				return static_cast<Derived*>(this)->ReadImplementation();
 			}
 
+			// Reads 'count' bytes to 'destination', and returns the iterator that follows them.
+			template<typename OutputIterator>
+			OutputIterator ReadBlock(const OutputIterator destination, const std::size_t count)
+			{
+				return static_cast<Derived*>(this)->ReadBlockImplementation(destination, count);
+			}
+
+			// Called once reading is done. Inputs which read ahead of what was consumed use this to return the rest.
+			void Finish()
+			{
+				static_cast<Derived*>(this)->FinishImplementation();
+			}
+
 			template<unsigned int total_bytes, Endian endian>
 			requires (total_bytes >= 1) && (total_bytes <= 4)
 			auto Read()
@@ -124,6 +161,35 @@ namespace ClownLZSS
 			void ResetImplementation()
 			{}
 
+			void FinishImplementation()
+			{}
+
+			// Outputs which can handle many bytes at once more quickly than one at a time should provide their own versions of these.
+			void WriteBlockImplementation(const unsigned char* const data, const std::size_t size)
+			{
+				for (std::size_t i = 0; i < size; ++i)
+					Write(data[i]);
+			}
+
+			void FillImplementation(const unsigned char value, const std::size_t count)
+			{
+				for (std::size_t i = 0; i < count; ++i)
+					Write(value);
+			}
+
+			template<typename Input>
+			void CopyFromImplementation(Input &input, const std::size_t count)
+			{
+				for (std::size_t i = 0; i < count; ++i)
+					Write(input.Read());
+			}
+
+			// Outputs which can read back what was written to them should provide their own version of this.
+			bool RepeatImplementation([[maybe_unused]] const auto &first, [[maybe_unused]] const std::size_t count)
+			{
+				return false;
+			}
+
 		public:
 			OutputCommonBase()
 			{
@@ -164,16 +230,42 @@ namespace ClownLZSS
 				Write<2, Endian::Little>(value);
 			}
 
-			void Fill(const unsigned char value, const unsigned int count)
+			void WriteBlock(const unsigned char* const data, const std::size_t size)
 			{
-				for (unsigned int i = 0; i < count; ++i)
-					Write(value);
+				static_cast<Derived*>(this)->WriteBlockImplementation(data, size);
+			}
+
+			void Fill(const unsigned char value, const std::size_t count)
+			{
+				static_cast<Derived*>(this)->FillImplementation(value, count);
+			}
+
+			// Writes the next 'count' bytes of 'input'.
+			template<typename Input>
+			void CopyFrom(Input &input, const std::size_t count)
+			{
+				static_cast<Derived*>(this)->CopyFromImplementation(input, count);
+			}
+
+			// Writes another copy of the 'count' bytes that were written starting at 'first'.
+			// Returns false if the output is unable to read them back, in which case nothing is written.
+			template<typename Position>
+			bool Repeat(const Position &first, const std::size_t count)
+			{
+				return static_cast<Derived*>(this)->RepeatImplementation(first, count);
 			}
 
 			void Reset()
 			{
 				static_cast<Derived*>(this)->ResetImplementation();
 			}
+
+			// Called once writing is done, so that outputs which buffer their data can pass the rest of it on.
+			// Such outputs try to do this when they are destroyed too, but any error would go unreported then.
+			void Finish()
+			{
+				static_cast<Derived*>(this)->FinishImplementation();
+			}
 		};
 
 		template<typename T, typename Derived>
@@ -199,6 +291,31 @@ namespace ClownLZSS
 				++iterator;
 			}
 
+			void WriteBlockImplementation(const unsigned char* const data, const std::size_t size)
+			{
+				auto destination = iterator;
+
+				for (std::size_t i = 0; i < size; ++i)
+				{
+					*destination = data[i];
+					++destination;
+				}
+
+				iterator = destination;
+			}
+
+			template<typename Input>
+			void CopyFromImplementation(Input &input, const std::size_t count)
+			{
+				iterator = input.ReadBlock(iterator, count);
+			}
+
+			bool RepeatImplementation(const Iterator &first, const std::size_t count)
+			{
+				iterator = std::copy_n(first, count, iterator);
+				return true;
+			}
+
 		public:
 			OutputCommon(Iterator iterator)
 				: IOIteratorCommon<T>(iterator)
@@ -212,32 +329,154 @@ namespace ClownLZSS
 		requires std::is_convertible_v<T&, std::ostream&>
 		class OutputCommon<T, Derived> : public OutputCommonBase<Derived>
 		{
+		public:
+			// Positions are relative to wherever the stream was when this object was created.
+			using pos_type = std::ostream::off_type;
+			using difference_type = std::ostream::off_type;
+
 		protected:
 			using Base = OutputCommonBase<Derived>;
 
 			std::ostream &output;
 
+			// Calling into the stream for every byte is very slow, so writes are gathered into
+			// this block and then sent to the stream all at once. Seeks that land within the
+			// block are handled here too, so that patching descriptor fields and headers is cheap.
+			std::array<char, 0x10000> block;
+			std::size_t block_index = 0;
+			std::size_t block_length = 0;
+			// The stream is always sitting at the position of the start of the block.
+			pos_type block_position = 0;
+
+			const int uncaught_exceptions = std::uncaught_exceptions();
+			bool finished = false;
+
+			void FlushBlock()
+			{
+				output.write(block.data(), block_length);
+				block_position += block_length;
+				block_index = block_length = 0;
+			}
+
 			void WriteImplementation(const unsigned char value)
 			{
-				output.put(value);
+				if (block_index == block.size())
+					FlushBlock();
+
+				block[block_index++] = value;
+				block_length = std::max(block_length, block_index);
 			}
 
-		public:
-			using pos_type = std::ostream::pos_type;
-			using difference_type = std::ostream::off_type;
+			// Passes the block to 'callback' in pieces, for it to write 'size' bytes to.
+			template<typename Callback>
+			void WriteToBlock(std::size_t size, const Callback &callback)
+			{
+				while (size != 0)
+				{
+					if (block_index == block.size())
+						FlushBlock();
+
+					const std::size_t amount = std::min(size, block.size() - block_index);
+
+					callback(&block[block_index], amount);
+					size -= amount;
+
+					block_index += amount;
+					block_length = std::max(block_length, block_index);
+				}
+			}
+
+			void WriteBlockImplementation(const unsigned char *data, const std::size_t size)
+			{
+				WriteToBlock(size, [&](char* const destination, const std::size_t amount)
+				{
+					std::copy(data, data + amount, destination);
+					data += amount;
+				});
+			}
+
+			void FillImplementation(const unsigned char value, const std::size_t count)
+			{
+				WriteToBlock(count, [&](char* const destination, const std::size_t amount)
+				{
+					std::fill_n(destination, amount, value);
+				});
+			}
 
+			template<typename Input>
+			void CopyFromImplementation(Input &input, const std::size_t count)
+			{
+				WriteToBlock(count, [&](char* const destination, const std::size_t amount)
+				{
+					input.ReadBlock(destination, amount);
+				});
+			}
+
+			// Only bytes which are still in the block can be read back, and only if the copy fits in the block too.
+			bool RepeatImplementation(const pos_type &first, const std::size_t count)
+			{
+				if (first < block_position || first - block_position + count > block_length || block_index + count > block.size())
+					return false;
+
+				std::copy_n(&block[first - block_position], count, &block[block_index]);
+				block_index += count;
+				block_length = std::max(block_length, block_index);
+				return true;
+			}
+
+			void FinishImplementation()
+			{
+				finished = true;
+
+				const auto end_offset = static_cast<difference_type>(block_index) - static_cast<difference_type>(block_length);
+
+				FlushBlock();
+
+				// Leave the stream where the caller would expect it to be.
+				if (end_offset != 0)
+					output.seekp(end_offset, output.cur);
+			}
+
+		public:
 			OutputCommon(std::ostream &output)
 				: output(output)
 			{}
 
+			OutputCommon(const OutputCommon &other) = delete;
+			OutputCommon& operator=(const OutputCommon &other) = delete;
+
+			// Destructors must not throw, so any failure to flush here is ignored. Call 'Finish' to have it reported.
+			// There is no point in flushing if the output is being abandoned due to an exception.
+			~OutputCommon()
+			{
+				if (!finished && std::uncaught_exceptions() == uncaught_exceptions)
+				{
+					try
+					{
+						FinishImplementation();
+					}
+					catch (...)
+					{}
+				}
+			}
+
 			pos_type Tell() const
 			{
-				return output.tellp();
+				return block_position + block_index;
 			};
 
 			void Seek(const pos_type &position)
 			{
-				output.seekp(position);
+				if (position >= block_position && position <= block_position + static_cast<difference_type>(block_length))
+				{
+					block_index = position - block_position;
+				}
+				else
+				{
+					FlushBlock();
+					output.seekp(position - block_position, output.cur);
+					block_position = position;
+				}
 			};
 
 			difference_type Distance(const pos_type &first) const
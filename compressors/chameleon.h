@@ -16,6 +16,7 @@ PERFORMANCE OF THIS SOFTWARE.
 #ifndef CLOWNLZSS_COMPRESSORS_CHAMELEON_H
 #define CLOWNLZSS_COMPRESSORS_CHAMELEON_H
 
+#include <span>
 #include <utility>
 
 #include "../bitfield.h"
@@ -24,6 +25,8 @@ PERFORMANCE OF THIS SOFTWARE.
 
 namespace ClownLZSS
 {
+	inline constexpr MatchSearch chameleon_match_search = {-1, 0xFF, 0x7FF, 1};
+
 	namespace Internal
 	{
 		namespace Chameleon
@@ -44,82 +47,81 @@ namespace ClownLZSS
 			}
 
 			template<typename T>
-			bool Compress(const unsigned char* const data, const std::size_t data_size, CompressorOutput<T> &output)
+			void EncodeDescriptorFields(const Matches &matches, const std::size_t total_matches, T &output)
 			{
-				/* Produce a series of LZSS compression matches. */
-				/* Yes, the first two values really are lower than usual by 1. */
-				ClownLZSS::Matches matches;
-				std::size_t total_matches;
-				if (!ClownLZSS::FindOptimalMatches(-1, 0xFF, 0x7FF, nullptr, 1 + 8, GetMatchCost, data, 1, data_size, &matches, &total_matches, nullptr))
-					return false;
-
-				/* Track the location of the header... */
-				const auto header_position = output.Tell();
-
-				/* ...and insert a placeholder there. */
-				output.WriteBE16(0);
+				BitFieldWriter<T> descriptor_bits(output);
 
+				/* Iterate over the compression matches, outputting just the descriptor fields. */
+				for (ClownLZSS_Match *match = &matches[0]; match != &matches[total_matches]; ++match)
 				{
-					BitFieldWriter<decltype(output)> descriptor_bits(output);
-
-					/* Produce Chameleon-formatted data. */
-					/* Unlike many other LZSS formats, Chameleon stores the descriptor fields separately from the rest of the data. */
-					/* Iterate over the compression matches, outputting just the descriptor fields. */
-					for (ClownLZSS_Match *match = &matches[0]; match != &matches[total_matches]; ++match)
+					if (CLOWNLZSS_MATCH_IS_LITERAL(match))
 					{
-						if (CLOWNLZSS_MATCH_IS_LITERAL(match))
+						descriptor_bits.Push(1);
+					}
+					else
+					{
+						const std::size_t distance = match->destination - match->source;
+						const std::size_t length = match->length;
+
+						if (length >= 2 && length <= 3 && distance < 0x100)
+						{
+							descriptor_bits.Push(0);
+							descriptor_bits.Push(0);
+							descriptor_bits.Push(length == 3);
+						}
+						else if (length >= 3 && length <= 5)
 						{
+							descriptor_bits.Push(0);
 							descriptor_bits.Push(1);
+							descriptor_bits.Push(!!(distance & (1 << 10)));
+							descriptor_bits.Push(!!(distance & (1 << 9)));
+							descriptor_bits.Push(!!(distance & (1 << 8)));
+							descriptor_bits.Push(length == 5);
+							descriptor_bits.Push(length == 4);
 						}
-						else
+						else /*if (length >= 6)*/
 						{
-							const std::size_t distance = match->destination - match->source;
-							const std::size_t length = match->length;
-
-							if (length >= 2 && length <= 3 && distance < 0x100)
-							{
-								descriptor_bits.Push(0);
-								descriptor_bits.Push(0);
-								descriptor_bits.Push(length == 3);
-							}
-							else if (length >= 3 && length <= 5)
-							{
-								descriptor_bits.Push(0);
-								descriptor_bits.Push(1);
-								descriptor_bits.Push(!!(distance & (1 << 10)));
-								descriptor_bits.Push(!!(distance & (1 << 9)));
-								descriptor_bits.Push(!!(distance & (1 << 8)));
-								descriptor_bits.Push(length == 5);
-								descriptor_bits.Push(length == 4);
-							}
-							else /*if (length >= 6)*/
-							{
-								descriptor_bits.Push(0);
-								descriptor_bits.Push(1);
-								descriptor_bits.Push(!!(distance & (1 << 10)));
-								descriptor_bits.Push(!!(distance & (1 << 9)));
-								descriptor_bits.Push(!!(distance & (1 << 8)));
-								descriptor_bits.Push(1);
-								descriptor_bits.Push(1);
-							}
+							descriptor_bits.Push(0);
+							descriptor_bits.Push(1);
+							descriptor_bits.Push(!!(distance & (1 << 10)));
+							descriptor_bits.Push(!!(distance & (1 << 9)));
+							descriptor_bits.Push(!!(distance & (1 << 8)));
+							descriptor_bits.Push(1);
+							descriptor_bits.Push(1);
 						}
 					}
-
-					/* Add the terminator match. */
-					descriptor_bits.Push(0);
-					descriptor_bits.Push(1);
-					descriptor_bits.Push(0);
-					descriptor_bits.Push(0);
-					descriptor_bits.Push(0);
-					descriptor_bits.Push(1);
-					descriptor_bits.Push(1);
 				}
 
-				/* Chameleon's header contains the size of the descriptor fields, so, now that we know that, let's fill it in. */
-				const auto current_position = output.Tell();
-				output.Seek(header_position);
-				output.WriteBE16(current_position - header_position - 2);
-				output.Seek(current_position);
+				/* Add the terminator match. */
+				descriptor_bits.Push(0);
+				descriptor_bits.Push(1);
+				descriptor_bits.Push(0);
+				descriptor_bits.Push(0);
+				descriptor_bits.Push(0);
+				descriptor_bits.Push(1);
+				descriptor_bits.Push(1);
+			}
+
+			template<typename T>
+			bool Compress(const unsigned char* const data, const std::size_t data_size, CompressorOutput<T> &output, const MatchCandidates* const candidates)
+			{
+				/* Produce a series of LZSS compression matches. */
+				/* Yes, the first two values really are lower than usual by 1. */
+				ClownLZSS::Matches matches;
+				std::size_t total_matches;
+				if (!ClownLZSS::FindOptimalMatches(candidates, chameleon_match_search, nullptr, 1 + 8, GetMatchCost, data, data_size, &matches, &total_matches, nullptr))
+					return false;
+
+				[[maybe_unused]] const EncodingTimer encoding_timer;
+
+				/* Chameleon's header contains the size of the descriptor fields, so work that out before writing anything. */
+				SizeCounter descriptor_fields_size;
+				EncodeDescriptorFields(matches, total_matches, descriptor_fields_size);
+				output.WriteBE16(descriptor_fields_size.Tell());
+
+				/* Produce Chameleon-formatted data. */
+				/* Unlike many other LZSS formats, Chameleon stores the descriptor fields separately from the rest of the data. */
+				EncodeDescriptorFields(matches, total_matches, output);
 
 				/* Iterate over the compression matches again, now outputting just the literals and offset/length pairs. */
 				for (ClownLZSS_Match *match = &matches[0]; match != &matches[total_matches]; ++match)
@@ -155,6 +157,12 @@ namespace ClownLZSS
 
 				return true;
 			}
+
+			template<typename T>
+			bool Compress(const unsigned char* const data, const std::size_t data_size, CompressorOutput<T> &output)
+			{
+				return Compress(data, data_size, output, nullptr);
+			}
 		}
 	}
 
@@ -164,7 +172,20 @@ namespace ClownLZSS
 		using namespace Internal;
 
 		CompressorOutput output_wrapped(std::forward<T>(output));
-		return Chameleon::Compress(data, data_size, output_wrapped);
+		const bool success = Chameleon::Compress(data, data_size, output_wrapped);
+		output_wrapped.Finish();
+		return success;
+	}
+
+	template<typename T>
+	bool ChameleonCompress(const MatchCandidates &candidates, T &&output)
+	{
+		using namespace Internal;
+
+		CompressorOutput output_wrapped(std::forward<T>(output));
+		const bool success = Chameleon::Compress(candidates.Get().data, candidates.Get().total_values * candidates.Get().bytes_per_value, output_wrapped, &candidates);
+		output_wrapped.Finish();
+		return success;
 	}
 
 	template<typename T>
@@ -173,7 +194,78 @@ namespace ClownLZSS
 		using namespace Internal;
 
 		CompressorOutput output_wrapped(std::forward<T>(output));
-		return ModuledCompressionWrapper<2, Endian::Big>(data, data_size, output_wrapped, Chameleon::Compress, module_size, 2);
+		const bool success = ModuledCompressionWrapper<2, Endian::Big>(data, data_size, output_wrapped, Chameleon::Compress, module_size, 2);
+		output_wrapped.Finish();
+		return success;
+	}
+
+	template<typename T>
+	bool ModuledChameleonCompress(const MatchCandidates &candidates, T &&output, const std::size_t module_size)
+	{
+		using namespace Internal;
+
+		CompressorOutput output_wrapped(std::forward<T>(output));
+		const bool success = ModuledCompressionWrapper<2, Endian::Big>(candidates.Get().data, candidates.Get().total_values * candidates.Get().bytes_per_value, output_wrapped, Chameleon::Compress, module_size, 2, &candidates);
+		output_wrapped.Finish();
+		return success;
+	}
+
+	constexpr std::size_t ChameleonCompressBound(const std::size_t data_size)
+	{
+		// The header holds the size of the descriptor fields.
+		return 2 + Internal::LiteralsBound(data_size, 1 + 8, 7 + 16, 1);
+	}
+
+	constexpr std::size_t ModuledChameleonCompressBound(const std::size_t data_size, const std::size_t module_size)
+	{
+		return Internal::ModuledCompressBound<2>(data_size, module_size, 2, ChameleonCompressBound);
+	}
+
+	inline bool ChameleonCompressedSize(const unsigned char* const data, const std::size_t data_size, std::size_t &compressed_size)
+	{
+		using namespace Internal;
+
+		return MeasureCompressedSize(compressed_size, [&](auto &output)
+		{
+			return Chameleon::Compress(data, data_size, output);
+		});
+	}
+
+	inline bool ModuledChameleonCompressedSize(const unsigned char* const data, const std::size_t data_size, std::size_t &compressed_size, const std::size_t module_size)
+	{
+		using namespace Internal;
+
+		return MeasureCompressedSize(compressed_size, [&](auto &output)
+		{
+			return ModuledCompressionWrapper<2, Endian::Big>(data, data_size, output, Chameleon::Compress, module_size, 2);
+		});
+	}
+
+	inline bool ChameleonEstimateCompressedSize(const unsigned char* const data, const std::size_t data_size, CompressedSizeEstimate &estimate)
+	{
+		using namespace Internal;
+
+		return EstimateCompressedSize(chameleon_match_search, 1 + 8, Chameleon::GetMatchCost, data, data_size, 7 + 16, 2, estimate, nullptr);
+	}
+
+	inline bool ChameleonCompress(const unsigned char* const data, const std::size_t data_size, const std::span<unsigned char> output, std::size_t &compressed_size)
+	{
+		using namespace Internal;
+
+		return CompressIntoSpan(output, compressed_size, [&](auto &output_wrapped)
+		{
+			return Chameleon::Compress(data, data_size, output_wrapped);
+		});
+	}
+
+	inline bool ModuledChameleonCompress(const unsigned char* const data, const std::size_t data_size, const std::span<unsigned char> output, std::size_t &compressed_size, const std::size_t module_size)
+	{
+		using namespace Internal;
+
+		return CompressIntoSpan(output, compressed_size, [&](auto &output_wrapped)
+		{
+			return ModuledCompressionWrapper<2, Endian::Big>(data, data_size, output_wrapped, Chameleon::Compress, module_size, 2);
+		});
 	}
 }
 
@@ -18,6 +18,279 @@ PERFORMANCE OF THIS SOFTWARE.
 #include <stddef.h>
 #include <stdlib.h>
 
+#ifdef CLOWNLZSS_STATISTICS
+ /* This file may also be compiled as C++. */
+ #if defined(CLOWNLZSS_CPLUSPLUS) && CLOWNLZSS_CPLUSPLUS >= 201703L
+  #define THREAD_LOCAL thread_local
+ #elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+  #define THREAD_LOCAL _Thread_local
+ #else
+  #error "Gathering statistics requires C11 or C++17, for thread-local storage and 'timespec_get'."
+ #endif
+
+ #include <time.h>
+#endif
+
+static const size_t DUMMY = -1;
+
+#ifdef CLOWNLZSS_STATISTICS
+/* Each thread gathers its own statistics, so that threads which compress at the same time do not mix theirs up. */
+static THREAD_LOCAL ClownLZSS_Statistics *current_statistics;
+static THREAD_LOCAL double phase_start_time;
+
+static double GetTime(void)
+{
+	struct timespec time;
+
+	timespec_get(&time, TIME_UTC);
+
+	return (double)time.tv_sec + (double)time.tv_nsec / 1000000000.0;
+}
+
+static void BeginPhase(void)
+{
+	if (current_statistics != NULL)
+		phase_start_time = GetTime();
+}
+
+/* Adds the time since the previous phase ended to this phase, and begins the next one. */
+static void EndPhase(double* const phase_time)
+{
+	const double time = GetTime();
+
+	*phase_time += time - phase_start_time;
+	phase_start_time = time;
+}
+
+static size_t GetHistogramBucket(size_t value)
+{
+	size_t bucket;
+
+	for (bucket = 0; value > 1 && bucket != CLOWNLZSS_STATISTICS_HISTOGRAM_SIZE - 1; ++bucket)
+		value >>= 1;
+
+	return bucket;
+}
+
+static void RecordMatch(const size_t source, const size_t destination, const size_t length)
+{
+	if (current_statistics == NULL)
+		return;
+
+	if (source == destination + 1)
+	{
+		++current_statistics->literals;
+	}
+	else
+	{
+		++current_statistics->matches;
+		++current_statistics->match_length_histogram[GetHistogramBucket(length)];
+		++current_statistics->match_distance_histogram[GetHistogramBucket(destination - source)];
+	}
+}
+
+#define STATISTICS_ADD(member, amount) do { if (current_statistics != NULL) current_statistics->member += (amount); } while (0)
+#define STATISTICS_BEGIN_PHASE() BeginPhase()
+#define STATISTICS_END_PHASE(phase) do { if (current_statistics != NULL) EndPhase(&current_statistics->phase); } while (0)
+#define STATISTICS_RECORD_MEMORY(bytes) do { if (current_statistics != NULL && current_statistics->peak_memory < (bytes)) current_statistics->peak_memory = (bytes); } while (0)
+#define STATISTICS_RECORD_MATCH(source, destination, length) RecordMatch(source, destination, length)
+#else
+/* Without statistics, these compile to nothing. */
+#define STATISTICS_ADD(member, amount) do {} while (0)
+#define STATISTICS_BEGIN_PHASE() do {} while (0)
+#define STATISTICS_END_PHASE(phase) do {} while (0)
+#define STATISTICS_RECORD_MEMORY(bytes) do {} while (0)
+#define STATISTICS_RECORD_MATCH(source, destination, length) do {} while (0)
+#endif
+
+static void InitialiseStringList(size_t* const prev, size_t* const next, const int filler_value, const size_t maximum_match_distance)
+{
+	size_t i;
+
+	/* Initialise the string list heads */
+	for (i = 0; i < 0x100; ++i)
+		next[maximum_match_distance + i] = DUMMY;
+
+	if (filler_value == -1)
+	{
+		/* Initialise the string list nodes */
+		for (i = 0; i < maximum_match_distance; ++i)
+			prev[i] = DUMMY;
+	}
+	else
+	{
+		next[maximum_match_distance + filler_value] = maximum_match_distance - 1;
+		next[0] = DUMMY;
+		prev[maximum_match_distance - 1] = maximum_match_distance + filler_value;
+
+		/* Initialise the string list nodes */
+		for (i = 0; i < maximum_match_distance - 1; ++i)
+		{
+			next[i + 1] = i;
+			prev[i] = i + 1;
+		}
+	}
+}
+
+static void AddToStringList(size_t* const prev, size_t* const next, const size_t string_list_head, const size_t current_string)
+{
+	/* Replace the oldest string in the list with the new string, since it's about to be pushed out of the LZSS sliding window */
+
+	/* Detach the old node in this slot */
+	if (prev[current_string] != DUMMY)
+		next[prev[current_string]] = DUMMY;
+
+	/* Replace the old node with this new one, and insert it at the start of its matching list */
+	prev[current_string] = string_list_head;
+	next[current_string] = next[string_list_head];
+
+	if (next[current_string] != DUMMY)
+		prev[next[current_string]] = current_string;
+
+	next[string_list_head] = current_string;
+}
+
+/* Returns how many values, starting at `start`, match those `distance` values back, up to `limit` */
+static size_t GetMatchLength(const unsigned char* const data, const size_t bytes_per_value, const int filler_value, const size_t position, const size_t distance, const size_t start, const size_t limit)
+{
+	size_t j;
+
+	const unsigned char *current_bytes = &data[(position + start) * bytes_per_value];
+	const unsigned char *match_bytes = current_bytes - distance * bytes_per_value;
+
+	for (j = start; j < limit; ++j)
+	{
+		size_t l;
+
+		if (match_bytes < data)
+		{
+			for (l = 0; l < bytes_per_value; ++l)
+			{
+				const unsigned char current_byte = *current_bytes;
+				const unsigned char match_byte = (unsigned char)filler_value;
+
+				++current_bytes;
+
+				if (current_byte != match_byte)
+					break;
+			}
+
+			match_bytes += bytes_per_value;
+		}
+		else
+		{
+			for (l = 0; l < bytes_per_value; ++l)
+			{
+				const unsigned char current_byte = *current_bytes;
+				const unsigned char match_byte = *match_bytes;
+
+				++current_bytes;
+				++match_bytes;
+
+				if (current_byte != match_byte)
+					break;
+			}
+		}
+
+		STATISTICS_ADD(bytes_compared, l == bytes_per_value ? l : l + 1);
+
+		/* No match: give up on the current run */
+		if (l != bytes_per_value)
+			break;
+	}
+
+	return j;
+}
+
+static void ConsiderMatch(ClownLZSS_GraphEdge* const node_meta_array, size_t (* const match_cost_callback)(size_t distance, size_t length, void *user), const size_t position, const size_t distance, const size_t start, const size_t length, const void* const user)
+{
+	size_t j;
+
+	for (j = start; j < length; ++j)
+	{
+		/* Figure out how much it costs to encode the current run */
+		const size_t cost = match_cost_callback(distance, j + 1, (void*)user);
+
+		STATISTICS_ADD(match_cost_callbacks, 1);
+
+		/* Figure out if the cost is lower than that of any other runs that end at the same value as this one */
+		if (cost != 0 && node_meta_array[position + j + 1].u.cost > node_meta_array[position].u.cost + cost)
+		{
+			STATISTICS_ADD(edges_relaxed, 1);
+
+			/* Record this new best run in the graph edge assigned to the value at the end of the run */
+			node_meta_array[position + j + 1].u.cost = node_meta_array[position].u.cost + cost;
+			node_meta_array[position + j + 1].previous_node_index = position;
+			node_meta_array[position + j + 1].match_offset = position - distance;
+		}
+	}
+}
+
+static void ConsiderLiteral(ClownLZSS_GraphEdge* const node_meta_array, const size_t literal_cost, const size_t position)
+{
+	/* If a literal match is more efficient than all runs assigned to this value, then use that instead */
+	if (node_meta_array[position + 1].u.cost >= node_meta_array[position].u.cost + literal_cost)
+	{
+		STATISTICS_ADD(edges_relaxed, 1);
+
+		node_meta_array[position + 1].u.cost = node_meta_array[position].u.cost + literal_cost;
+		node_meta_array[position + 1].previous_node_index = position;
+		node_meta_array[position + 1].match_offset = position + 1;
+	}
+}
+
+static void InitialiseCosts(ClownLZSS_GraphEdge* const node_meta_array, const size_t total_values)
+{
+	size_t i;
+
+	/* Set costs to maximum possible value, so later comparisons work */
+	node_meta_array[0].u.cost = 0;
+	for (i = 1; i < total_values + 1; ++i)
+		node_meta_array[i].u.cost = DUMMY;
+}
+
+static void ProduceMatches(ClownLZSS_GraphEdge* const node_meta_array, const size_t total_values, ClownLZSS_Match** const _matches, size_t* const _total_matches)
+{
+	size_t i;
+	ClownLZSS_Match *matches;
+	size_t total_matches;
+
+	/* At this point, the edges will have formed a shortest-path from the start to the end:
+	   You just have to start at the last edge, and follow it backwards all the way to the start. */
+
+	/* Mark start/end nodes for the following loops */
+	node_meta_array[0].previous_node_index = DUMMY;
+	node_meta_array[total_values].u.next_node_index = DUMMY;
+
+	/* Reverse the direction of the edges, so we can parse the LZSS graph from start to end */
+	for (i = total_values; node_meta_array[i].previous_node_index != DUMMY; i = node_meta_array[i].previous_node_index)
+		node_meta_array[node_meta_array[i].previous_node_index].u.next_node_index = i;
+
+	/* Produce an array of LZSS matches for the caller to process. It's safe to overwrite the LZSS graph to do this. */
+	matches = (ClownLZSS_Match*)node_meta_array;
+	total_matches = 0;
+
+	i = 0;
+	while (node_meta_array[i].u.next_node_index != DUMMY)
+	{
+		const size_t next_index = node_meta_array[i].u.next_node_index;
+		const size_t offset = node_meta_array[next_index].match_offset;
+
+		matches[total_matches].source = offset;
+		matches[total_matches].destination = i;
+		matches[total_matches].length = next_index - i;
+
+		STATISTICS_RECORD_MATCH(offset, i, next_index - i);
+
+		++total_matches;
+
+		i = next_index;
+	}
+
+	*_matches = matches;
+	*_total_matches = total_matches;
+}
+
 int ClownLZSS_FindOptimalMatches(
 	const int filler_value,
 	const size_t maximum_match_length,
@@ -48,46 +321,30 @@ int ClownLZSS_FindOptimalMatches(
 	{
 		const size_t node_meta_array_length = total_values + 1; /* +1 for the end-node */
 		const size_t string_list_buffer_length = maximum_match_distance * 2 + 0x100;
-		ClownLZSS_GraphEdge* const node_meta_array = (ClownLZSS_GraphEdge*)malloc(node_meta_array_length * sizeof(ClownLZSS_GraphEdge) + string_list_buffer_length * sizeof(size_t));
+		const size_t buffer_size = node_meta_array_length * sizeof(ClownLZSS_GraphEdge) + string_list_buffer_length * sizeof(size_t);
+		ClownLZSS_GraphEdge *node_meta_array;
+
+		STATISTICS_BEGIN_PHASE();
+
+		node_meta_array = (ClownLZSS_GraphEdge*)malloc(buffer_size);
 
 		if (node_meta_array != NULL)
 		{
 			size_t i;
-			ClownLZSS_Match *matches;
-			size_t total_matches;
 
 			size_t* const prev = (size_t*)&node_meta_array[node_meta_array_length];
 			size_t* const next = &prev[maximum_match_distance];
-			const size_t DUMMY = -1;
 
-			/* Initialise the string list heads */
-			for (i = 0; i < 0x100; ++i)
-				next[maximum_match_distance + i] = DUMMY;
+			/* If `BYTES_PER_VALUE` is not 1, then we have to re-evaluate the first value, otherwise we can skip it */
+			const size_t start = bytes_per_value == 1;
 
-			if (filler_value == -1)
-			{
-				/* Initialise the string list nodes */
-				for (i = 0; i < maximum_match_distance; ++i)
-					prev[i] = DUMMY;
-			}
-			else
-			{
-				next[maximum_match_distance + filler_value] = maximum_match_distance - 1;
-				next[0] = DUMMY;
-				prev[maximum_match_distance - 1] = maximum_match_distance + filler_value;
+			STATISTICS_ADD(input_bytes, total_values * bytes_per_value);
+			STATISTICS_RECORD_MEMORY(buffer_size);
 
-				/* Initialise the string list nodes */
-				for (i = 0; i < maximum_match_distance - 1; ++i)
-				{
-					next[i + 1] = i;
-					prev[i] = i + 1;
-				}
-			}
+			InitialiseStringList(prev, next, filler_value, maximum_match_distance);
+			InitialiseCosts(node_meta_array, total_values);
 
-			/* Set costs to maximum possible value, so later comparisons work */
-			node_meta_array[0].u.cost = 0;
-			for (i = 1; i < total_values + 1; ++i)
-				node_meta_array[i].u.cost = DUMMY;
+			STATISTICS_END_PHASE(initialisation_time);
 
 			/* Search for matches, to populate the edges of the LZSS graph.
 			   Notably, while doing this, we're also using a shortest-path
@@ -102,8 +359,13 @@ int ClownLZSS_FindOptimalMatches(
 				const size_t string_list_head = maximum_match_distance + data[i * bytes_per_value];
 				const size_t current_string = i % maximum_match_distance;
 
+				STATISTICS_ADD(positions, 1);
+
 				if (extra_matches_callback != NULL)
+				{
 					extra_matches_callback(data, total_values, i, node_meta_array, (void*)user);
+					STATISTICS_ADD(extra_matches_callbacks, 1);
+				}
 
 				/* `string_list_head` points to a linked-list of strings in the LZSS sliding window that match at least
 				   one byte with the current string: iterate over it and generate every possible match for this string */
@@ -112,11 +374,12 @@ int ClownLZSS_FindOptimalMatches(
 					size_t j;
 
 					const size_t distance = ((maximum_match_distance + i - match_string - 1) % maximum_match_distance) + 1;
-					/* If `BYTES_PER_VALUE` is not 1, then we have to re-evaluate the first value, otherwise we can skip it */
-					const unsigned int start = bytes_per_value == 1;
 					const unsigned char *current_bytes = &data[(i + start) * bytes_per_value];
 					const unsigned char *match_bytes = current_bytes - distance * bytes_per_value;
 
+					STATISTICS_ADD(candidates_walked, 1);
+
+					/* This is `GetMatchLength` and `ConsiderMatch` combined, since doing both in one pass is faster */
 					for (j = start; j < CLOWNLZSS_MIN(maximum_match_length, total_values - i); ++j)
 					{
 						size_t l;
@@ -151,6 +414,8 @@ int ClownLZSS_FindOptimalMatches(
 							}
 						}
 
+						STATISTICS_ADD(bytes_compared, l == bytes_per_value ? l : l + 1);
+
 						if (l != bytes_per_value)
 						{
 							/* No match: give up on the current run */
@@ -161,9 +426,13 @@ int ClownLZSS_FindOptimalMatches(
 							/* Figure out how much it costs to encode the current run */
 							const size_t cost = match_cost_callback(distance, j + 1, (void*)user);
 
+							STATISTICS_ADD(match_cost_callbacks, 1);
+
 							/* Figure out if the cost is lower than that of any other runs that end at the same value as this one */
 							if (cost != 0 && node_meta_array[i + j + 1].u.cost > node_meta_array[i].u.cost + cost)
 							{
+								STATISTICS_ADD(edges_relaxed, 1);
+
 								/* Record this new best run in the graph edge assigned to the value at the end of the run */
 								node_meta_array[i + j + 1].u.cost = node_meta_array[i].u.cost + cost;
 								node_meta_array[i + j + 1].previous_node_index = i;
@@ -173,65 +442,452 @@ int ClownLZSS_FindOptimalMatches(
 					}
 				}
 
-				/* If a literal match is more efficient than all runs assigned to this value, then use that instead */
-				if (node_meta_array[i + 1].u.cost >= node_meta_array[i].u.cost + literal_cost)
+				ConsiderLiteral(node_meta_array, literal_cost, i);
+
+				AddToStringList(prev, next, string_list_head, current_string);
+			}
+
+			STATISTICS_END_PHASE(search_time);
+
+			ProduceMatches(node_meta_array, total_values, _matches, _total_matches);
+
+			STATISTICS_END_PHASE(backtrack_time);
+
+			success = 1;
+		}
+	}
+
+	return success;
+}
+
+int ClownLZSS_FindMatchCandidates(
+	const int filler_value,
+	const size_t maximum_match_length,
+	const size_t maximum_match_distance,
+	const unsigned char* const data,
+	const size_t bytes_per_value,
+	const size_t total_values,
+	ClownLZSS_MatchCandidates* const candidates
+)
+{
+	int success;
+
+	size_t *prev, *first_candidates;
+	ClownLZSS_MatchCandidate *candidate_list;
+
+	/* Most values will have at most one candidate, so start with space for that many. */
+	size_t capacity = total_values + 1;
+	size_t total_candidates = 0;
+
+	STATISTICS_BEGIN_PHASE();
+
+	prev = (size_t*)malloc((maximum_match_distance * 2 + 0x100) * sizeof(size_t));
+	first_candidates = (size_t*)malloc((total_values + 1) * sizeof(size_t));
+	candidate_list = (ClownLZSS_MatchCandidate*)malloc(capacity * sizeof(ClownLZSS_MatchCandidate));
+
+	success = 0;
+
+	if (prev != NULL && first_candidates != NULL && candidate_list != NULL)
+	{
+		size_t i;
+
+		size_t* const next = &prev[maximum_match_distance];
+		const size_t start = bytes_per_value == 1;
+
+		success = 1;
+
+		STATISTICS_ADD(input_bytes, total_values * bytes_per_value);
+
+		InitialiseStringList(prev, next, filler_value, maximum_match_distance);
+
+		STATISTICS_END_PHASE(initialisation_time);
+
+		for (i = 0; i < total_values; ++i)
+		{
+			size_t match_string;
+
+			const size_t string_list_head = maximum_match_distance + data[i * bytes_per_value];
+			const size_t current_string = i % maximum_match_distance;
+			const size_t limit = CLOWNLZSS_MIN(maximum_match_length, total_values - i);
+
+			size_t longest_length = start;
+
+			first_candidates[i] = total_candidates;
+
+			STATISTICS_ADD(positions, 1);
+
+			/* The strings are ordered from nearest to furthest, and the cost of a match never goes down as its distance goes up,
+			   so a match is only worth keeping if it is longer than every nearer one. The exception is a distance of 1, which
+			   some formats cannot encode, so it does not stop a further match of the same length from being kept. */
+			for (match_string = next[string_list_head]; match_string != DUMMY && longest_length != limit; match_string = next[match_string])
+			{
+				const size_t distance = ((maximum_match_distance + i - match_string - 1) % maximum_match_distance) + 1;
+				const size_t length = GetMatchLength(data, bytes_per_value, filler_value, i, distance, start, limit);
+
+				STATISTICS_ADD(candidates_walked, 1);
+
+				if (length > (distance == 1 ? start : longest_length))
+				{
+					if (total_candidates == capacity)
+					{
+						ClownLZSS_MatchCandidate* const new_candidate_list = (ClownLZSS_MatchCandidate*)realloc(candidate_list, capacity * 2 * sizeof(ClownLZSS_MatchCandidate));
+
+						if (new_candidate_list == NULL)
+						{
+							success = 0;
+							break;
+						}
+
+						candidate_list = new_candidate_list;
+						capacity *= 2;
+					}
+
+					candidate_list[total_candidates].distance = distance;
+					candidate_list[total_candidates].length = length;
+					++total_candidates;
+
+					if (distance != 1)
+						longest_length = length;
+				}
+			}
+
+			if (!success)
+				break;
+
+			AddToStringList(prev, next, string_list_head, current_string);
+		}
+
+		first_candidates[total_values] = total_candidates;
+
+		STATISTICS_RECORD_MEMORY((maximum_match_distance * 2 + 0x100 + total_values + 1) * sizeof(size_t) + capacity * sizeof(ClownLZSS_MatchCandidate));
+		STATISTICS_END_PHASE(search_time);
+	}
+
+	free(prev);
+
+	if (success)
+	{
+		candidates->filler_value = filler_value;
+		candidates->maximum_match_length = maximum_match_length;
+		candidates->maximum_match_distance = maximum_match_distance;
+		candidates->data = data;
+		candidates->bytes_per_value = bytes_per_value;
+		candidates->total_values = total_values;
+		candidates->first_candidates = first_candidates;
+		candidates->candidates = candidate_list;
+	}
+	else
+	{
+		free(first_candidates);
+		free(candidate_list);
+	}
+
+	return success;
+}
+
+void ClownLZSS_FreeMatchCandidates(ClownLZSS_MatchCandidates* const candidates)
+{
+	free(candidates->first_candidates);
+	free(candidates->candidates);
+
+	candidates->first_candidates = NULL;
+	candidates->candidates = NULL;
+}
+
+int ClownLZSS_FindOptimalMatchesFromCandidates(
+	const ClownLZSS_MatchCandidates* const candidates,
+	const int filler_value,
+	const size_t maximum_match_length,
+	const size_t maximum_match_distance,
+	void (* const extra_matches_callback)(const unsigned char *data, size_t total_values, size_t offset, ClownLZSS_GraphEdge *node_meta_array, void *user),
+	const size_t literal_cost,
+	size_t (* const match_cost_callback)(size_t distance, size_t length, void *user),
+	const size_t bytes_per_value,
+	ClownLZSS_Match** const _matches,
+	size_t* const _total_matches,
+	const void* const user
+)
+{
+	return ClownLZSS_FindOptimalMatchesFromCandidateRange(candidates, 0, candidates->total_values, filler_value, maximum_match_length, maximum_match_distance, extra_matches_callback, literal_cost, match_cost_callback, bytes_per_value, _matches, _total_matches, user);
+}
+
+int ClownLZSS_FindOptimalMatchesFromCandidateRange(
+	const ClownLZSS_MatchCandidates* const candidates,
+	const size_t first_value,
+	const size_t total_values,
+	const int filler_value,
+	const size_t maximum_match_length,
+	const size_t maximum_match_distance,
+	void (* const extra_matches_callback)(const unsigned char *data, size_t total_values, size_t offset, ClownLZSS_GraphEdge *node_meta_array, void *user),
+	const size_t literal_cost,
+	size_t (* const match_cost_callback)(size_t distance, size_t length, void *user),
+	const size_t bytes_per_value,
+	ClownLZSS_Match** const _matches,
+	size_t* const _total_matches,
+	const void* const user
+)
+{
+	int success;
+
+	success = 0;
+
+	/* The candidates must have been found with a search that is at least as thorough as this one would have been.
+	   A range which does not start at the beginning cannot have filler values before it, as the real data is there instead. */
+	if (filler_value != candidates->filler_value || bytes_per_value != candidates->bytes_per_value || maximum_match_length > candidates->maximum_match_length || maximum_match_distance > candidates->maximum_match_distance
+	 || first_value > candidates->total_values || total_values > candidates->total_values - first_value || (first_value != 0 && filler_value != -1))
+	{
+		/* Bail. */
+	}
+	else if (total_values == 0)
+	{
+		*_matches = NULL;
+		*_total_matches = 0;
+		success = 1;
+	}
+	else
+	{
+		ClownLZSS_GraphEdge *node_meta_array;
+
+		STATISTICS_BEGIN_PHASE();
+
+		node_meta_array = (ClownLZSS_GraphEdge*)malloc((total_values + 1) * sizeof(ClownLZSS_GraphEdge));
+
+		if (node_meta_array != NULL)
+		{
+			size_t i;
+
+			const unsigned char* const data = &candidates->data[first_value * bytes_per_value];
+			const size_t start = bytes_per_value == 1;
+
+			STATISTICS_ADD(input_bytes, total_values * bytes_per_value);
+			STATISTICS_RECORD_MEMORY((total_values + 1) * sizeof(ClownLZSS_GraphEdge));
+
+			InitialiseCosts(node_meta_array, total_values);
+
+			STATISTICS_END_PHASE(initialisation_time);
+
+			/* This is the same shortest-path search as above, except that the matches are already known. */
+			for (i = 0; i < total_values; ++i)
+			{
+				size_t candidate;
+
+				/* Matches cannot reach back past the start of the range, nor forward past its end. */
+				const size_t distance_limit = first_value == 0 ? maximum_match_distance : CLOWNLZSS_MIN(maximum_match_distance, i);
+				const size_t length_limit = CLOWNLZSS_MIN(maximum_match_length, total_values - i);
+
+				STATISTICS_ADD(positions, 1);
+
+				if (extra_matches_callback != NULL)
 				{
-					node_meta_array[i + 1].u.cost = node_meta_array[i].u.cost + literal_cost;
-					node_meta_array[i + 1].previous_node_index = i;
-					node_meta_array[i + 1].match_offset = i + 1;
+					extra_matches_callback(data, total_values, i, node_meta_array, (void*)user);
+					STATISTICS_ADD(extra_matches_callbacks, 1);
 				}
 
-				/* Replace the oldest string in the list with the new string, since it's about to be pushed out of the LZSS sliding window */
+				for (candidate = candidates->first_candidates[first_value + i]; candidate != candidates->first_candidates[first_value + i + 1]; ++candidate)
+				{
+					const ClownLZSS_MatchCandidate* const match = &candidates->candidates[candidate];
 
-				/* Detach the old node in this slot */
-				if (prev[current_string] != DUMMY)
-					next[prev[current_string]] = DUMMY;
+					STATISTICS_ADD(candidates_walked, 1);
 
-				/* Replace the old node with this new one, and insert it at the start of its matching list */
-				prev[current_string] = string_list_head;
-				next[current_string] = next[string_list_head];
+					/* The candidates are ordered from nearest to furthest, so none of the rest will be in range either. */
+					if (match->distance > distance_limit)
+						break;
 
-				if (next[current_string] != DUMMY)
-					prev[next[current_string]] = current_string;
+					ConsiderMatch(node_meta_array, match_cost_callback, i, match->distance, start, CLOWNLZSS_MIN(match->length, length_limit), user);
+				}
 
-				next[string_list_head] = current_string;
+				ConsiderLiteral(node_meta_array, literal_cost, i);
 			}
 
-			/* At this point, the edges will have formed a shortest-path from the start to the end:
-			   You just have to start at the last edge, and follow it backwards all the way to the start. */
+			STATISTICS_END_PHASE(search_time);
 
-			/* Mark start/end nodes for the following loops */
-			node_meta_array[0].previous_node_index = DUMMY;
-			node_meta_array[total_values].u.next_node_index = DUMMY;
+			ProduceMatches(node_meta_array, total_values, _matches, _total_matches);
 
-			/* Reverse the direction of the edges, so we can parse the LZSS graph from start to end */
-			for (i = total_values; node_meta_array[i].previous_node_index != DUMMY; i = node_meta_array[i].previous_node_index)
-				node_meta_array[node_meta_array[i].previous_node_index].u.next_node_index = i;
+			STATISTICS_END_PHASE(backtrack_time);
 
-			/* Produce an array of LZSS matches for the caller to process. It's safe to overwrite the LZSS graph to do this. */
-			matches = (ClownLZSS_Match*)node_meta_array;
-			total_matches = 0;
+			success = 1;
+		}
+	}
+
+	return success;
+}
+
+/* The estimator only needs the rough size of the interval, so this avoids depending on the maths library. */
+static double SquareRoot(const double value)
+{
+	double root;
+	unsigned int i;
+
+	if (value <= 0.0)
+		return 0.0;
+
+	root = value < 1.0 ? 1.0 : value;
+
+	for (i = 0; i < 64; ++i)
+		root = (root + value / root) / 2.0;
+
+	return root;
+}
+
+#define ESTIMATE_HASH_SIZE 0x10000
+#define ESTIMATE_MAXIMUM_PROBES 0x20
+
+/* Values are found by their first byte and the first byte of the value after them. */
+static size_t GetEstimateHash(const unsigned char* const data, const size_t bytes_per_value, const size_t position)
+{
+	return (size_t)data[position * bytes_per_value] << 8 | data[(position + 1) * bytes_per_value];
+}
+
+int ClownLZSS_EstimateCost(
+	const size_t maximum_match_length,
+	const size_t maximum_match_distance,
+	const size_t literal_cost,
+	size_t (* const match_cost_callback)(size_t distance, size_t length, void *user),
+	const unsigned char* const data,
+	const size_t bytes_per_value,
+	const size_t total_values,
+	size_t sample_length,
+	size_t total_samples,
+	ClownLZSS_CostEstimate* const estimate,
+	const void* const user
+)
+{
+	int success;
+
+	size_t *heads, *chain;
+
+	success = 0;
+
+	/* If the samples would cover all of the data anyway, then just parse all of it in one go. */
+	if (sample_length == 0 || total_samples == 0 || sample_length > total_values / total_samples)
+	{
+		sample_length = total_values;
+		total_samples = 1;
+	}
+
+	/* Handle the edge-case where the data is empty. */
+	if (total_values == 0)
+	{
+		estimate->cost = estimate->lowest_cost = estimate->highest_cost = 0;
+		success = 1;
+	}
+	else if ((heads = (size_t*)malloc((ESTIMATE_HASH_SIZE + maximum_match_distance + sample_length) * sizeof(size_t))) != NULL)
+	{
+		size_t sample;
+		double sum = 0.0, sum_of_squares = 0.0, mean, half_width;
+
+		const size_t stride = total_samples == 1 ? 0 : (total_values - sample_length) / (total_samples - 1);
 
-			i = 0;
-			while (node_meta_array[i].u.next_node_index != DUMMY)
+		chain = &heads[ESTIMATE_HASH_SIZE];
+
+		for (sample = 0; sample < total_samples; ++sample)
+		{
+			size_t i, position, cost;
+			double projected_cost;
+
+			const size_t sample_start = sample * stride;
+			const size_t sample_end = sample_start + sample_length;
+			/* The data just before the sample is available to be matched against, but is not itself counted. */
+			const size_t window_start = sample_start - CLOWNLZSS_MIN(maximum_match_distance, sample_start);
+
+			for (i = 0; i < ESTIMATE_HASH_SIZE; ++i)
+				heads[i] = DUMMY;
+
+			for (position = window_start; position < sample_start; ++position)
 			{
-				const size_t next_index = node_meta_array[i].u.next_node_index;
-				const size_t offset = node_meta_array[next_index].match_offset;
+				const size_t hash = GetEstimateHash(data, bytes_per_value, position);
+
+				chain[position - window_start] = heads[hash];
+				heads[hash] = position;
+			}
+
+			/* Parse the sample greedily, taking whichever match saves the most over literals.
+			   This is far cheaper than finding the optimal matches, but is also slightly worse. */
+			cost = 0;
+
+			while (position < sample_end)
+			{
+				size_t best_saving = 0, best_cost = 0, best_length = 1;
+
+				if (position + 1 < sample_end)
+				{
+					size_t match_position, probes;
+
+					const size_t limit = CLOWNLZSS_MIN(maximum_match_length, sample_end - position);
 
-				matches[total_matches].source = offset;
-				matches[total_matches].destination = i;
-				matches[total_matches].length = next_index - i;
+					for (match_position = heads[GetEstimateHash(data, bytes_per_value, position)], probes = 0; match_position != DUMMY && position - match_position <= maximum_match_distance && probes < ESTIMATE_MAXIMUM_PROBES; match_position = chain[match_position - window_start], ++probes)
+					{
+						const size_t distance = position - match_position;
+						const size_t length = GetMatchLength(data, bytes_per_value, -1, position, distance, 0, limit);
+						const size_t match_cost = length == 0 ? 0 : match_cost_callback(distance, length, (void*)user);
 
-				++total_matches;
+						if (match_cost != 0 && length * literal_cost > match_cost && length * literal_cost - match_cost > best_saving)
+						{
+							best_saving = length * literal_cost - match_cost;
+							best_cost = match_cost;
+							best_length = length;
+						}
+					}
+				}
+
+				cost += best_saving != 0 ? best_cost : literal_cost;
+
+				for (i = 0; i < best_length; ++i, ++position)
+				{
+					if (position + 1 < total_values)
+					{
+						const size_t hash = GetEstimateHash(data, bytes_per_value, position);
 
-				i = next_index;
+						chain[position - window_start] = heads[hash];
+						heads[hash] = position;
+					}
+				}
 			}
 
-			*_matches = matches;
-			*_total_matches = total_matches;
-			success = 1;
+			/* Scale the cost of the sample up to the size of the whole data. */
+			projected_cost = (double)cost * total_values / sample_length;
+			sum += projected_cost;
+			sum_of_squares += projected_cost * projected_cost;
 		}
+
+		mean = sum / total_samples;
+
+		/* A 95% confidence interval for the mean, with a correction for the samples covering a fair chunk of the data. */
+		if (total_samples == 1)
+		{
+			half_width = 0.0;
+		}
+		else
+		{
+			const double variance = (sum_of_squares - sum * mean) / (total_samples - 1);
+			const double sampled_fraction = (double)sample_length * total_samples / total_values;
+
+			half_width = 1.96 * SquareRoot(variance / total_samples * (1.0 - sampled_fraction));
+		}
+
+		estimate->cost = (size_t)(mean + 0.5);
+		estimate->lowest_cost = mean > half_width ? (size_t)(mean - half_width) : 0;
+		estimate->highest_cost = (size_t)(mean + half_width + 0.5);
+
+		free(heads);
+		success = 1;
 	}
 
 	return success;
 }
+
+#ifdef CLOWNLZSS_STATISTICS
+ClownLZSS_Statistics* ClownLZSS_SetStatistics(ClownLZSS_Statistics* const statistics)
+{
+	ClownLZSS_Statistics* const previous_statistics = current_statistics;
+
+	current_statistics = statistics;
+
+	return previous_statistics;
+}
+
+ClownLZSS_Statistics* ClownLZSS_GetStatistics(void)
+{
+	return current_statistics;
+}
+#endif
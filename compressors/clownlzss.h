@@ -51,6 +51,66 @@ typedef struct ClownLZSS_Match
 
 #define CLOWNLZSS_MATCH_IS_LITERAL(match) ((match)->source == (match)->destination + 1)
 
+typedef struct ClownLZSS_MatchCandidate
+{
+	size_t distance;
+	size_t length;
+} ClownLZSS_MatchCandidate;
+
+/* The matches available at each value of some data, found once so that several formats, or
+   variants of one format, can each find their optimal matches without searching all over again. */
+typedef struct ClownLZSS_MatchCandidates
+{
+	int filler_value;
+	size_t maximum_match_length;
+	size_t maximum_match_distance;
+	const unsigned char *data;
+	size_t bytes_per_value;
+	size_t total_values;
+	/* The index of each value's first candidate. There is one more of these than there are values, to mark the end of the last value's candidates. */
+	size_t *first_candidates;
+	ClownLZSS_MatchCandidate *candidates;
+} ClownLZSS_MatchCandidates;
+
+/* A projection of the cost of some data, along with a 95% confidence interval. */
+typedef struct ClownLZSS_CostEstimate
+{
+	size_t cost;
+	size_t lowest_cost;
+	size_t highest_cost;
+} ClownLZSS_CostEstimate;
+
+#ifdef CLOWNLZSS_STATISTICS
+#define CLOWNLZSS_STATISTICS_HISTOGRAM_SIZE 16
+
+/* Measurements of where the time of compression goes, for comparing and tuning match searches against real data.
+   Gathering these slows compression down, so they only exist when `CLOWNLZSS_STATISTICS` is defined.
+   Everything accumulates across searches, apart from the peak memory, which is that of the largest single search. */
+typedef struct ClownLZSS_Statistics
+{
+	size_t input_bytes;
+	size_t positions;
+	/* Strings in the sliding window, or previously-found candidates, which were checked for a match. */
+	size_t candidates_walked;
+	size_t bytes_compared;
+	/* How many times a cheaper path to a value was found. */
+	size_t edges_relaxed;
+	size_t match_cost_callbacks;
+	size_t extra_matches_callbacks;
+	size_t literals;
+	size_t matches;
+	/* Bucket `i` counts the matches with a length or distance from 2^i up to 2^(i+1), with the last bucket counting anything larger too. */
+	size_t match_length_histogram[CLOWNLZSS_STATISTICS_HISTOGRAM_SIZE];
+	size_t match_distance_histogram[CLOWNLZSS_STATISTICS_HISTOGRAM_SIZE];
+	size_t peak_memory;
+	/* Wall time, in seconds. */
+	double initialisation_time;
+	double search_time;
+	double backtrack_time;
+	double encode_time;
+} ClownLZSS_Statistics;
+#endif
+
 #ifdef CLOWNLZSS_CPLUSPLUS
 extern "C" {
 #endif
@@ -70,12 +130,84 @@ int ClownLZSS_FindOptimalMatches(
 	const void *user
 );
 
+int ClownLZSS_FindMatchCandidates(
+	int filler_value,
+	size_t maximum_match_length,
+	size_t maximum_match_distance,
+	const unsigned char *data,
+	size_t bytes_per_value,
+	size_t total_values,
+	ClownLZSS_MatchCandidates *candidates
+);
+
+void ClownLZSS_FreeMatchCandidates(ClownLZSS_MatchCandidates *candidates);
+
+/* Produces the same matches as `ClownLZSS_FindOptimalMatches`, provided that the candidates were found with the same filler value
+   and bytes-per-value, and with a maximum match length and distance that are at least as large. Otherwise, this fails. */
+int ClownLZSS_FindOptimalMatchesFromCandidates(
+	const ClownLZSS_MatchCandidates *candidates,
+	int filler_value,
+	size_t maximum_match_length,
+	size_t maximum_match_distance,
+	void (*extra_matches_callback)(const unsigned char *data, size_t total_values, size_t offset, ClownLZSS_GraphEdge *node_meta_array, void *user),
+	size_t literal_cost,
+	size_t (*match_cost_callback)(size_t distance, size_t length, void *user),
+	size_t bytes_per_value,
+	ClownLZSS_Match **matches,
+	size_t *total_matches,
+	const void *user
+);
+
+/* The same as `ClownLZSS_FindOptimalMatchesFromCandidates`, but for only part of the data, as if that part had been searched on its own.
+   This lets the data be split into pieces without searching each piece separately, but only for formats without a filler value. */
+int ClownLZSS_FindOptimalMatchesFromCandidateRange(
+	const ClownLZSS_MatchCandidates *candidates,
+	size_t first_value,
+	size_t total_values,
+	int filler_value,
+	size_t maximum_match_length,
+	size_t maximum_match_distance,
+	void (*extra_matches_callback)(const unsigned char *data, size_t total_values, size_t offset, ClownLZSS_GraphEdge *node_meta_array, void *user),
+	size_t literal_cost,
+	size_t (*match_cost_callback)(size_t distance, size_t length, void *user),
+	size_t bytes_per_value,
+	ClownLZSS_Match **matches,
+	size_t *total_matches,
+	const void *user
+);
+
+/* Projects the cost that `ClownLZSS_FindOptimalMatches` would arrive at, by greedily parsing evenly-spaced samples of the data.
+   This is much faster, but tends to overestimate slightly, and does not account for filler values or extra matches. */
+int ClownLZSS_EstimateCost(
+	size_t maximum_match_length,
+	size_t maximum_match_distance,
+	size_t literal_cost,
+	size_t (*match_cost_callback)(size_t distance, size_t length, void *user),
+	const unsigned char *data,
+	size_t bytes_per_value,
+	size_t total_values,
+	size_t sample_length,
+	size_t total_samples,
+	ClownLZSS_CostEstimate *estimate,
+	const void *user
+);
+
+#ifdef CLOWNLZSS_STATISTICS
+/* Sets where the statistics of the current thread are gathered, and returns where they were gathered before.
+   A null pointer stops them from being gathered. */
+ClownLZSS_Statistics* ClownLZSS_SetStatistics(ClownLZSS_Statistics *statistics);
+ClownLZSS_Statistics* ClownLZSS_GetStatistics(void);
+#endif
+
 #ifdef CLOWNLZSS_CPLUSPLUS
 }
 #endif
 
 #if defined(CLOWNLZSS_CPLUSPLUS) && CLOWNLZSS_CPLUSPLUS >= 201103L
 #include <memory>
+#ifdef CLOWNLZSS_STATISTICS
+#include <chrono>
+#endif
 
 namespace ClownLZSS
 {
@@ -92,6 +224,53 @@ namespace ClownLZSS
 
 	using Matches = std::unique_ptr<ClownLZSS_Match[], Internal::MatchDeleter>;
 
+#ifdef CLOWNLZSS_STATISTICS
+	// Gathers the statistics of everything that the current thread compresses, for as long as this exists.
+	class GatherStatistics
+	{
+	private:
+		ClownLZSS_Statistics *previous_statistics;
+
+	public:
+		GatherStatistics(ClownLZSS_Statistics &statistics)
+			: previous_statistics(ClownLZSS_SetStatistics(&statistics))
+		{}
+
+		GatherStatistics(const GatherStatistics &other) = delete;
+		GatherStatistics& operator=(const GatherStatistics &other) = delete;
+
+		~GatherStatistics()
+		{
+			ClownLZSS_SetStatistics(previous_statistics);
+		}
+	};
+#endif
+
+	namespace Internal
+	{
+		// Adds the time from its creation to its destruction to the encoding time of the statistics.
+		// Without statistics, this does nothing at all.
+		class EncodingTimer
+		{
+	#ifdef CLOWNLZSS_STATISTICS
+		private:
+			ClownLZSS_Statistics *statistics = ClownLZSS_GetStatistics();
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+		public:
+			EncodingTimer() = default;
+			EncodingTimer(const EncodingTimer &other) = delete;
+			EncodingTimer& operator=(const EncodingTimer &other) = delete;
+
+			~EncodingTimer()
+			{
+				if (statistics != nullptr)
+					statistics->encode_time += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			}
+	#endif
+		};
+	}
+
 	inline bool FindOptimalMatches(
 		int filler_value,
 		size_t maximum_match_length,
@@ -114,6 +293,125 @@ namespace ClownLZSS
 
 		return success;
 	}
+
+	// The parameters of the match search of a format. Searches which share a filler value and bytes-per-value
+	// can be combined, so that a single set of match candidates can be used by all of those formats.
+	struct MatchSearch
+	{
+		int filler_value;
+		size_t maximum_match_length;
+		size_t maximum_match_distance;
+		size_t bytes_per_value;
+	};
+
+	constexpr MatchSearch CombineMatchSearches(const MatchSearch &a, const MatchSearch &b)
+	{
+		return MatchSearch{a.filler_value, CLOWNLZSS_MAX(a.maximum_match_length, b.maximum_match_length), CLOWNLZSS_MAX(a.maximum_match_distance, b.maximum_match_distance), a.bytes_per_value};
+	}
+
+	// Candidates that are found for the whole of the data can also be used for any part of it, such as a single
+	// module, provided that the format has no filler value. This allows moduled data to be searched just once.
+	class MatchCandidates
+	{
+	private:
+		ClownLZSS_MatchCandidates candidates = {};
+
+	public:
+		MatchCandidates() = default;
+		MatchCandidates(const MatchCandidates &other) = delete;
+		MatchCandidates& operator=(const MatchCandidates &other) = delete;
+
+		~MatchCandidates()
+		{
+			ClownLZSS_FreeMatchCandidates(&candidates);
+		}
+
+		bool Find(const MatchSearch &search, const unsigned char* const data, const size_t total_values)
+		{
+			ClownLZSS_FreeMatchCandidates(&candidates);
+			return ClownLZSS_FindMatchCandidates(search.filler_value, search.maximum_match_length, search.maximum_match_distance, data, search.bytes_per_value, total_values, &candidates);
+		}
+
+		const ClownLZSS_MatchCandidates& Get() const
+		{
+			return candidates;
+		}
+	};
+
+	// Uses the match candidates if there are any, and otherwise searches for matches.
+	inline bool FindOptimalMatches(
+		const MatchCandidates *candidates,
+		const MatchSearch &search,
+		void (*extra_matches_callback)(const unsigned char *data, size_t total_values, size_t offset, ClownLZSS_GraphEdge *node_meta_array, void *user),
+		size_t literal_cost,
+		size_t (*match_cost_callback)(size_t distance, size_t length, void *user),
+		const unsigned char *data,
+		size_t total_values,
+		Matches *matches,
+		size_t *total_matches,
+		const void *user
+	)
+	{
+		if (candidates == nullptr)
+			return FindOptimalMatches(search.filler_value, search.maximum_match_length, search.maximum_match_distance, extra_matches_callback, literal_cost, match_cost_callback, data, search.bytes_per_value, total_values, matches, total_matches, user);
+
+		// The data may be just part of what the candidates were found for, such as a single module.
+		const ClownLZSS_MatchCandidates &all_candidates = candidates->Get();
+		const size_t values_bytes = all_candidates.total_values * all_candidates.bytes_per_value;
+
+		if (all_candidates.first_candidates == nullptr || data < all_candidates.data || data > all_candidates.data + values_bytes || static_cast<size_t>(data - all_candidates.data) % all_candidates.bytes_per_value != 0)
+			return false;
+
+		ClownLZSS_Match *matches_pointer;
+		const bool success = ClownLZSS_FindOptimalMatchesFromCandidateRange(&all_candidates, (data - all_candidates.data) / all_candidates.bytes_per_value, total_values, search.filler_value, search.maximum_match_length, search.maximum_match_distance, extra_matches_callback, literal_cost, match_cost_callback, search.bytes_per_value, &matches_pointer, total_matches, user);
+
+		if (success)
+			*matches = Matches(matches_pointer);
+
+		return success;
+	}
+
+	// A projection of the size of some compressed data, along with a 95% confidence interval.
+	struct CompressedSizeEstimate
+	{
+		size_t size;
+		size_t lowest_size;
+		size_t highest_size;
+	};
+
+	namespace Internal
+	{
+		// Data which is smaller than this is simply parsed in full.
+		inline constexpr size_t estimate_sample_length = 0x1000;
+		inline constexpr size_t estimate_total_samples = 0x10;
+
+		// The extra bits and bytes are for things like terminators and headers, which are not part of the matches.
+		inline bool EstimateCompressedSize(
+			const MatchSearch &search,
+			size_t literal_cost,
+			size_t (*match_cost_callback)(size_t distance, size_t length, void *user),
+			const unsigned char *data,
+			size_t total_values,
+			size_t extra_bits,
+			size_t extra_bytes,
+			CompressedSizeEstimate &estimate,
+			const void *user
+		)
+		{
+			ClownLZSS_CostEstimate cost;
+
+			if (!ClownLZSS_EstimateCost(search.maximum_match_length, search.maximum_match_distance, literal_cost, match_cost_callback, data, search.bytes_per_value, total_values, estimate_sample_length, estimate_total_samples, &cost, user))
+				return false;
+
+			const auto BitsToBytes = [&](const size_t bits)
+			{
+				return (bits + extra_bits + 7) / 8 + extra_bytes;
+			};
+
+			estimate = {BitsToBytes(cost.cost), BitsToBytes(cost.lowest_cost), BitsToBytes(cost.highest_cost)};
+			return true;
+		}
+	}
 }
 #endif
 
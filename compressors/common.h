@@ -18,10 +18,15 @@ PERFORMANCE OF THIS SOFTWARE.
 
 #include "../common.h"
 
+#include <algorithm>
+#include <cstddef>
 #include <iterator>
 #if __STDC_HOSTED__
 	#include <ostream>
+	#include <string_view>
+	#include <unordered_map>
 #endif
+#include <span>
 #include <type_traits>
 
 namespace ClownLZSS
@@ -59,15 +64,210 @@ namespace ClownLZSS
 	};
 	#endif
 
+	// Writes to a caller-provided buffer. Anything which does not fit is counted but discarded, so that
+	// running out of space can be reported once compression is done instead of overrunning the buffer.
+	template<typename T>
+	requires std::is_same_v<std::remove_cvref_t<T>, std::span<unsigned char>>
+	class CompressorOutput<T> : public Internal::OutputCommonBase<CompressorOutput<T>>
+	{
+	protected:
+		using Base = Internal::OutputCommonBase<CompressorOutput<T>>;
+
+		std::span<unsigned char> buffer;
+		std::size_t position = 0;
+
+		std::size_t SpaceRemaining() const
+		{
+			return position < buffer.size() ? buffer.size() - position : 0;
+		}
+
+		void WriteImplementation(const unsigned char value)
+		{
+			if (position < buffer.size())
+				buffer[position] = value;
+
+			++position;
+		}
+
+		void WriteBlockImplementation(const unsigned char* const data, const std::size_t data_size)
+		{
+			std::copy_n(data, std::min(data_size, SpaceRemaining()), buffer.data() + std::min(position, buffer.size()));
+			position += data_size;
+		}
+
+		void FillImplementation(const unsigned char value, const std::size_t count)
+		{
+			std::fill_n(buffer.data() + std::min(position, buffer.size()), std::min(count, SpaceRemaining()), value);
+			position += count;
+		}
+
+		// Bytes which did not fit cannot be read back, but the output has overflowed by then anyway, so only the count matters.
+		bool RepeatImplementation(const std::size_t first, const std::size_t count)
+		{
+			if (first + count <= buffer.size())
+				std::copy_n(buffer.data() + first, std::min(count, SpaceRemaining()), buffer.data() + std::min(position, buffer.size()));
+
+			position += count;
+			return true;
+		}
+
+	public:
+		using pos_type = std::size_t;
+		using difference_type = std::ptrdiff_t;
+
+		CompressorOutput(const std::span<unsigned char> buffer)
+			: buffer(buffer)
+		{}
+
+		pos_type Tell() const
+		{
+			return position;
+		}
+
+		difference_type Distance(const pos_type &first) const
+		{
+			return Distance(first, Tell());
+		}
+
+		static difference_type Distance(const pos_type &first, const pos_type &last)
+		{
+			return last - first;
+		}
+
+		bool Overflowed() const
+		{
+			return position > buffer.size();
+		}
+
+		friend Base;
+	};
+
+	// An output that discards everything written to it, for learning how large some data will be before writing it.
+	template<typename T>
+	requires std::is_same_v<T, Internal::Discard>
+	class CompressorOutput<T> : public Internal::OutputCommonBase<CompressorOutput<T>>
+	{
+	protected:
+		using Base = Internal::OutputCommonBase<CompressorOutput<T>>;
+
+		std::size_t size = 0;
+
+		void WriteImplementation([[maybe_unused]] const unsigned char value)
+		{
+			++size;
+		}
+
+		void WriteBlockImplementation([[maybe_unused]] const unsigned char* const data, const std::size_t data_size)
+		{
+			size += data_size;
+		}
+
+		void FillImplementation([[maybe_unused]] const unsigned char value, const std::size_t count)
+		{
+			size += count;
+		}
+
+		bool RepeatImplementation([[maybe_unused]] const std::size_t first, const std::size_t count)
+		{
+			size += count;
+			return true;
+		}
+
+	public:
+		using pos_type = std::size_t;
+		using difference_type = std::ptrdiff_t;
+
+		pos_type Tell() const
+		{
+			return size;
+		}
+
+		difference_type Distance(const pos_type &first) const
+		{
+			return Distance(first, Tell());
+		}
+
+		static difference_type Distance(const pos_type &first, const pos_type &last)
+		{
+			return last - first;
+		}
+
+		friend Base;
+	};
+
 	namespace Internal
 	{
-		template<unsigned int total_bytes, Endian endian, typename T>
-		bool ModuledCompressionWrapper(const unsigned char* const data, const std::size_t data_size, CompressorOutput<T> &output, bool (* const compression_function)(const unsigned char *data, std::size_t data_size, CompressorOutput<T> &output), const std::size_t module_size, const std::size_t module_alignment)
+		using SizeCounter = CompressorOutput<Discard>;
+
+		// Remembers where each module was compressed to, so that a module with the same contents as an earlier one can copy its
+		// compressed data instead of being compressed all over again. Without the standard library, nothing is remembered.
+		// Nor is anything remembered when 'enabled' is false, for outputs which promise not to allocate memory or throw.
+		template<typename Position, bool enabled>
+		class PreviousModules
+		{
+		public:
+			struct Module
+			{
+				const unsigned char *data;
+				std::size_t data_size;
+				Position position;
+				std::size_t compressed_size;
+			};
+
+		private:
+		#if __STDC_HOSTED__
+			struct Nothing {};
+
+			[[no_unique_address]] std::conditional_t<enabled, std::unordered_map<std::size_t, Module>, Nothing> modules;
+
+			static std::size_t Hash(const unsigned char* const data, const std::size_t data_size)
+			{
+				return std::hash<std::string_view>()(std::string_view(reinterpret_cast<const char*>(data), data_size));
+			}
+		#endif
+
+		public:
+			const Module* Find([[maybe_unused]] const unsigned char* const data, [[maybe_unused]] const std::size_t data_size) const
+			{
+			#if __STDC_HOSTED__
+				if constexpr (enabled)
+				{
+					const auto module = modules.find(Hash(data, data_size));
+
+					if (module != modules.cend() && module->second.data_size == data_size && std::equal(data, data + data_size, module->second.data))
+						return &module->second;
+				}
+			#endif
+
+				return nullptr;
+			}
+
+			void Add([[maybe_unused]] const Module &module)
+			{
+			#if __STDC_HOSTED__
+				// Should two different modules share a hash, then only the first is remembered.
+				if constexpr (enabled)
+					modules.try_emplace(Hash(module.data, module.data_size), module);
+			#endif
+			}
+		};
+
+		// Any extra arguments are passed along to the compression function, such as match candidates for the whole of the data.
+		template<unsigned int total_bytes, Endian endian, typename T, typename... Arguments>
+		bool ModuledCompressionWrapper(const unsigned char* const data, const std::size_t data_size, CompressorOutput<T> &output, bool (* const compression_function)(const unsigned char *data, std::size_t data_size, CompressorOutput<T> &output, Arguments... arguments), const std::size_t module_size, const std::size_t module_alignment, const Arguments... arguments)
 		{
+			// The number of whole modules goes above the bottom 12 bits of the header, so there must not be too many of them.
+			if (data_size / module_size >= std::size_t(1) << (total_bytes * 8 - 12))
+				return false;
+
 			const auto header = (data_size % module_size) | ((data_size / module_size) << 12);
 
 			output.template Write<total_bytes, endian>(header);
 
+			// Modules are compressed independently of one another, so identical modules produce identical compressed data.
+			// Fixed-size buffers go without, as remembering the modules would need memory to be allocated.
+			PreviousModules<typename CompressorOutput<T>::pos_type, !std::is_same_v<std::remove_cvref_t<T>, std::span<unsigned char>>> previous_modules;
+
 			typename CompressorOutput<T>::difference_type compressed_size = 0;
 			for (std::size_t i = 0; i < data_size; i += module_size)
 			{
@@ -75,15 +275,76 @@ namespace ClownLZSS
 					output.Fill(0, module_alignment - (compressed_size % module_alignment));
 
 				const auto start_position = output.Tell();
+				const auto module_data = data + i;
+				const auto module_data_size = module_size < data_size - i ? module_size : data_size - i;
+				const auto previous_module = previous_modules.Find(module_data, module_data_size);
+
+				if (previous_module == nullptr || !output.Repeat(previous_module->position, previous_module->compressed_size))
+				{
+					if (!compression_function(module_data, module_data_size, output, arguments...))
+						return false;
 
-				if (!compression_function(data + i, module_size < data_size - i ? module_size : data_size - i, output))
-					return false;
+					previous_modules.Add({module_data, module_data_size, start_position, static_cast<std::size_t>(output.Distance(start_position))});
+				}
 
 				compressed_size = output.Distance(start_position);
 			}
 
 			return true;
 		}
+
+		// Compresses into a caller-provided buffer. On success, 'compressed_size' is set to the number of bytes written.
+		// If the buffer is too small, then false is returned and 'compressed_size' is set to the size that was needed.
+		template<typename Callback>
+		bool CompressIntoSpan(const std::span<unsigned char> buffer, std::size_t &compressed_size, const Callback &callback)
+		{
+			CompressorOutput<std::span<unsigned char>> output(buffer);
+
+			if (!callback(output))
+				return false;
+
+			compressed_size = output.Tell();
+			return !output.Overflowed();
+		}
+
+		// Runs the compressor without producing any output, for learning how large the compressed data will be.
+		template<typename Callback>
+		bool MeasureCompressedSize(std::size_t &compressed_size, const Callback &callback)
+		{
+			SizeCounter output;
+
+			if (!callback(output))
+				return false;
+
+			compressed_size = output.Tell();
+			return true;
+		}
+
+		// The optimal parse never costs more than encoding everything as literals, so that, plus the
+		// terminator and whatever is left of the final descriptor fields, is the most that can be output.
+		constexpr std::size_t LiteralsBound(const std::size_t total_values, const std::size_t literal_cost, const std::size_t terminator_cost, const std::size_t descriptor_field_bytes)
+		{
+			return (total_values * literal_cost + terminator_cost + 7) / 8 + descriptor_field_bytes * 2;
+		}
+
+		template<unsigned int total_bytes>
+		constexpr std::size_t ModuledCompressBound(const std::size_t data_size, const std::size_t module_size, const std::size_t module_alignment, std::size_t (* const bound_function)(std::size_t data_size))
+		{
+			const std::size_t total_whole_modules = data_size / module_size;
+			const std::size_t remainder = data_size % module_size;
+			const std::size_t total_modules = total_whole_modules + (remainder != 0);
+
+			std::size_t bound = total_bytes + total_whole_modules * bound_function(module_size);
+
+			if (remainder != 0)
+				bound += bound_function(remainder);
+
+			// Every module but the first may be preceded by padding.
+			if (total_modules != 0)
+				bound += (total_modules - 1) * (module_alignment - 1);
+
+			return bound;
+		}
 	}
 }
 
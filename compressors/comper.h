@@ -16,6 +16,7 @@ PERFORMANCE OF THIS SOFTWARE.
 #ifndef CLOWNLZSS_COMPRESSORS_COMPER_H
 #define CLOWNLZSS_COMPRESSORS_COMPER_H
 
+#include <span>
 #include <utility>
 
 #include "../bitfield.h"
@@ -24,6 +25,8 @@ PERFORMANCE OF THIS SOFTWARE.
 
 namespace ClownLZSS
 {
+	inline constexpr MatchSearch comper_match_search = {-1, 0x100, 0x100, 2};
+
 	namespace Internal
 	{
 		namespace Comper
@@ -37,7 +40,7 @@ namespace ClownLZSS
 			}
 
 			template<typename T>
-			bool Compress(const unsigned char* const data, const std::size_t data_size, CompressorOutput<T> &output)
+			bool Compress(const unsigned char* const data, const std::size_t data_size, CompressorOutput<T> &output, const MatchCandidates* const candidates)
 			{
 				constexpr unsigned int bytes_per_value = 2;
 
@@ -48,9 +51,11 @@ namespace ClownLZSS
 				// Produce a series of LZSS compression matches.
 				ClownLZSS::Matches matches;
 				std::size_t total_matches;
-				if (!ClownLZSS::FindOptimalMatches(-1, 0x100, 0x100, nullptr, 1 + 16, GetMatchCost, data, bytes_per_value, data_size / bytes_per_value, &matches, &total_matches, nullptr))
+				if (!ClownLZSS::FindOptimalMatches(candidates, comper_match_search, nullptr, 1 + 16, GetMatchCost, data, data_size / bytes_per_value, &matches, &total_matches, nullptr))
 					return false;
 
+				[[maybe_unused]] const EncodingTimer encoding_timer;
+
 				DescriptorFieldWriter<decltype(output)> descriptor_bits(output);
 
 				// Produce Comper-formatted data.
@@ -59,8 +64,8 @@ namespace ClownLZSS
 					if (CLOWNLZSS_MATCH_IS_LITERAL(match))
 					{
 						descriptor_bits.Push(0);
-						output.Write(data[match->destination * 2 + 0]);
-						output.Write(data[match->destination * 2 + 1]);
+						descriptor_bits.Write(data[match->destination * 2 + 0]);
+						descriptor_bits.Write(data[match->destination * 2 + 1]);
 					}
 					else
 					{
@@ -69,17 +74,23 @@ namespace ClownLZSS
 						const std::size_t offset = 0 - distance;
 
 						descriptor_bits.Push(1);
-						output.Write(offset & 0xFF);
-						output.Write(length - 1);
+						descriptor_bits.Write(offset & 0xFF);
+						descriptor_bits.Write(length - 1);
 					}
 				}
 
 				// Add the terminator match.
 				descriptor_bits.Push(1);
-				output.Write(0);
-				output.Write(0);
+				descriptor_bits.Write(0);
+				descriptor_bits.Write(0);
+
+				return descriptor_bits.Finish();
+			}
 
-				return true;
+			template<typename T>
+			bool Compress(const unsigned char* const data, const std::size_t data_size, CompressorOutput<T> &output)
+			{
+				return Compress(data, data_size, output, nullptr);
 			}
 		}
 	}
@@ -90,7 +101,20 @@ namespace ClownLZSS
 		using namespace Internal;
 
 		CompressorOutput output_wrapped(std::forward<T>(output));
-		return Comper::Compress(data, data_size, output_wrapped);
+		const bool success = Comper::Compress(data, data_size, output_wrapped);
+		output_wrapped.Finish();
+		return success;
+	}
+
+	template<typename T>
+	bool ComperCompress(const MatchCandidates &candidates, T &&output)
+	{
+		using namespace Internal;
+
+		CompressorOutput output_wrapped(std::forward<T>(output));
+		const bool success = Comper::Compress(candidates.Get().data, candidates.Get().total_values * candidates.Get().bytes_per_value, output_wrapped, &candidates);
+		output_wrapped.Finish();
+		return success;
 	}
 
 	template<typename T>
@@ -99,7 +123,78 @@ namespace ClownLZSS
 		using namespace Internal;
 
 		CompressorOutput output_wrapped(std::forward<T>(output));
-		return ModuledCompressionWrapper<2, Endian::Big>(data, data_size, output_wrapped, Comper::Compress, module_size, 2);
+		const bool success = ModuledCompressionWrapper<2, Endian::Big>(data, data_size, output_wrapped, Comper::Compress, module_size, 2);
+		output_wrapped.Finish();
+		return success;
+	}
+
+	template<typename T>
+	bool ModuledComperCompress(const MatchCandidates &candidates, T &&output, const std::size_t module_size)
+	{
+		using namespace Internal;
+
+		CompressorOutput output_wrapped(std::forward<T>(output));
+		const bool success = ModuledCompressionWrapper<2, Endian::Big>(candidates.Get().data, candidates.Get().total_values * candidates.Get().bytes_per_value, output_wrapped, Comper::Compress, module_size, 2, &candidates);
+		output_wrapped.Finish();
+		return success;
+	}
+
+	constexpr std::size_t ComperCompressBound(const std::size_t data_size)
+	{
+		// Literals are whole words.
+		return Internal::LiteralsBound((data_size + 1) / 2, 1 + 16, 1 + 16, 2);
+	}
+
+	constexpr std::size_t ModuledComperCompressBound(const std::size_t data_size, const std::size_t module_size)
+	{
+		return Internal::ModuledCompressBound<2>(data_size, module_size, 2, ComperCompressBound);
+	}
+
+	inline bool ComperCompressedSize(const unsigned char* const data, const std::size_t data_size, std::size_t &compressed_size)
+	{
+		using namespace Internal;
+
+		return MeasureCompressedSize(compressed_size, [&](auto &output)
+		{
+			return Comper::Compress(data, data_size, output);
+		});
+	}
+
+	inline bool ModuledComperCompressedSize(const unsigned char* const data, const std::size_t data_size, std::size_t &compressed_size, const std::size_t module_size)
+	{
+		using namespace Internal;
+
+		return MeasureCompressedSize(compressed_size, [&](auto &output)
+		{
+			return ModuledCompressionWrapper<2, Endian::Big>(data, data_size, output, Comper::Compress, module_size, 2);
+		});
+	}
+
+	inline bool ComperEstimateCompressedSize(const unsigned char* const data, const std::size_t data_size, CompressedSizeEstimate &estimate)
+	{
+		using namespace Internal;
+
+		return EstimateCompressedSize(comper_match_search, 1 + 16, Comper::GetMatchCost, data, data_size / 2, 1 + 16, 0, estimate, nullptr);
+	}
+
+	inline bool ComperCompress(const unsigned char* const data, const std::size_t data_size, const std::span<unsigned char> output, std::size_t &compressed_size)
+	{
+		using namespace Internal;
+
+		return CompressIntoSpan(output, compressed_size, [&](auto &output_wrapped)
+		{
+			return Comper::Compress(data, data_size, output_wrapped);
+		});
+	}
+
+	inline bool ModuledComperCompress(const unsigned char* const data, const std::size_t data_size, const std::span<unsigned char> output, std::size_t &compressed_size, const std::size_t module_size)
+	{
+		using namespace Internal;
+
+		return CompressIntoSpan(output, compressed_size, [&](auto &output_wrapped)
+		{
+			return ModuledCompressionWrapper<2, Endian::Big>(data, data_size, output_wrapped, Comper::Compress, module_size, 2);
+		});
 	}
 }
 
@@ -20,6 +20,7 @@ PERFORMANCE OF THIS SOFTWARE.
 #include <bit>
 #include <cstdlib>
 #include <optional>
+#include <span>
 #include <utility>
 
 #include "../bitfield.h"
@@ -65,15 +66,7 @@ namespace ClownLZSS
 
 				const auto FindSpecialValues = [&ReadWord, &GetTileIndex](const unsigned char* const data, const std::size_t data_size) -> std::optional<SpecialValues>
 				{
-					// Copy the input buffer.
 					const std::size_t total_values = data_size / bytes_per_value;
-					unsigned short* const sort_buffer = static_cast<unsigned short*>(std::malloc(total_values * sizeof(unsigned short)));
-
-					if (sort_buffer == nullptr)
-						return std::nullopt;
-
-					for (std::size_t i = 0; i < data_size; i += bytes_per_value)
-						sort_buffer[i / bytes_per_value] = ReadWord(data + i);
 
 					// Emulate the bizarre quirk where the incremental copy word is set to zero if,
 					// and only if, the data begins with a series of zeroes followed by a one.
@@ -81,51 +74,43 @@ namespace ClownLZSS
 
 					for (std::size_t i = 1; i < total_values; ++i)
 					{
-						if (sort_buffer[i] == sort_buffer[i - 1] + 1)
+						const unsigned int previous_value = ReadWord(data + (i - 1) * bytes_per_value);
+
+						if (ReadWord(data + i * bytes_per_value) == previous_value + 1)
 						{
-							if (GetTileIndex(sort_buffer[i - 1]) == 0)
-								lowest_value = sort_buffer[0];
+							if (GetTileIndex(previous_value) == 0)
+								lowest_value = ReadWord(data);
 							break;
 						}
 					}
 
-					// Sort the input buffer.
-					std::sort(&sort_buffer[0], &sort_buffer[total_values]);
-
-					// Find the longest run of a single value. This is the most common value.
-					unsigned int run_length = 0;
-					unsigned int run_value = sort_buffer[0];
+					// Count how many times each value occurs.
+					std::size_t* const histogram = static_cast<std::size_t*>(std::calloc(0x10000, sizeof(std::size_t)));
 
-					unsigned int longest_run_length = run_length;
-					unsigned int longest_run_value = run_value;
+					if (histogram == nullptr)
+						return std::nullopt;
 
-					for (std::size_t i = 0; i < total_values; ++i)
-					{
-						const unsigned int this_value = sort_buffer[i];
+					for (std::size_t i = 0; i < data_size; i += bytes_per_value)
+						++histogram[ReadWord(data + i)];
 
-						if (GetTileIndex(this_value) != 0) // Labyrinth Zone's 16x16 blocks rely on this odd masking.
-							lowest_value = std::min(lowest_value, this_value);
+					// Find the most common value, preferring the lowest one in the event of a tie.
+					unsigned int most_common_value = 0;
 
-						if (run_value == this_value)
+					for (unsigned int value = 0; value < 0x10000; ++value)
+					{
+						if (histogram[value] != 0)
 						{
-							++run_length;
+							if (histogram[most_common_value] < histogram[value])
+								most_common_value = value;
 
-							if (longest_run_length < run_length)
-							{
-								longest_run_length = run_length;
-								longest_run_value = run_value;
-							}
-						}
-						else
-						{
-							run_length = 1;
-							run_value = this_value;
+							if (GetTileIndex(value) != 0) // Labyrinth Zone's 16x16 blocks rely on this odd masking.
+								lowest_value = std::min(lowest_value, value);
 						}
 					}
 
-					std::free(sort_buffer);
+					std::free(histogram);
 
-					return SpecialValues{longest_run_value, lowest_value};
+					return SpecialValues{most_common_value, lowest_value};
 				};
 
 				auto special_values = FindSpecialValues(data, data_size);
@@ -133,6 +118,42 @@ namespace ClownLZSS
 				if (!special_values.has_value())
 					return false;
 
+				// Find the length of every run of same, incrementing and decrementing values up-front,
+				// so that they do not have to be searched for again at each of the many points where
+				// a run is considered. Each is found by extending the run which begins after it.
+				struct RunLengths
+				{
+					unsigned char same, increment, decrement;
+				};
+
+				const std::size_t total_values = data_size / bytes_per_value;
+
+				RunLengths* const run_lengths = static_cast<RunLengths*>(std::malloc(total_values * sizeof(RunLengths)));
+
+				if (run_lengths == nullptr)
+					return false;
+
+				for (std::size_t i = total_values; i-- != 0; )
+				{
+					const unsigned int value = ReadWord(data + i * bytes_per_value);
+
+					RunLengths &lengths = run_lengths[i];
+					lengths = {1, 1, 1};
+
+					if (i + 1 != total_values)
+					{
+						const unsigned int next_value = ReadWord(data + (i + 1) * bytes_per_value);
+						const RunLengths &next_lengths = run_lengths[i + 1];
+
+						if (next_value == value)
+							lengths.same += std::min<unsigned int>(next_lengths.same, 0xF);
+						if (next_value == value + 1)
+							lengths.increment += std::min<unsigned int>(next_lengths.increment, 0xF);
+						if (next_value == value - 1)
+							lengths.decrement += std::min<unsigned int>(next_lengths.decrement, 0xF);
+					}
+				}
+
 				// Here, we determine the inline value length and render flag bitmask.
 				// To begin with, we bitwise-OR all words together.
 				unsigned int combined = 0;
@@ -141,6 +162,7 @@ namespace ClownLZSS
 
 				const unsigned int inline_value_length = std::bit_width(GetTileIndex(combined));
 				const unsigned int render_flags_mask = combined >> (16 - 5);
+				const unsigned int total_render_flag_bits = std::popcount(render_flags_mask);
 
 				output.Write(inline_value_length);
 				output.Write(render_flags_mask);
@@ -174,44 +196,19 @@ namespace ClownLZSS
 
 					const auto GetRun = [&](const unsigned char* const input)
 					{
-						const unsigned int maximum_length = std::min<unsigned int>(0x10, GetWordsRemaining(input));
-
 						const unsigned int first_value = ReadWord(input);
 
-						const auto GetRunLength = [&]<typename Callback>(Callback callback)
-						{
-							unsigned int i;
-							for (i = 1; i < maximum_length; ++i)
-							{
-								const unsigned int this_value = ReadWord(input + i * bytes_per_value);
-								
-								if (callback(this_value, i))
-									break;
-							}
+						const RunLengths &lengths = run_lengths[std::distance(data, input) / bytes_per_value];
 
-							return i;
-						};
-
-						const auto LiteralRunCallback = [&](const unsigned int this_value, [[maybe_unused]] const unsigned int index)
-						{
-							return this_value != first_value;
-						};
-
-						const unsigned int literal_run_length = GetRunLength(LiteralRunCallback);
+						const unsigned int literal_run_length = lengths.same;
+						const unsigned int decrement_run_length = lengths.decrement;
 
-						const auto IncrementRunCallback = [&](const unsigned int this_value, const unsigned int index)
-						{
-							return this_value != first_value + index || this_value == special_values->lowest;
-						};
-
-						const unsigned int increment_run_length = GetRunLength(IncrementRunCallback);
+						// Incrementing runs stop at the incremental copy word, but that changes as it is used, so it
+						// has to be accounted for here. Being an incrementing run, the word can only be in one place.
+						unsigned int increment_run_length = lengths.increment;
 
-						const auto DecrementRunCallback = [&](const unsigned int this_value, const unsigned int index)
-						{
-							return this_value != first_value - index;
-						};
-
-						const unsigned int decrement_run_length = GetRunLength(DecrementRunCallback);
+						if (special_values->lowest > first_value && special_values->lowest - first_value < increment_run_length)
+							increment_run_length = special_values->lowest - first_value;
 
 						// Always prefer special matches to inline matches, even if the inline matches are longer.
 						if (first_value == special_values->lowest && increment_run_length)
@@ -297,12 +294,19 @@ namespace ClownLZSS
 					{
 						const unsigned int value = ReadWord(input);
 
-						// Push render flag bits.
+						// Gather the render flag bits which are present, and push them along with the tile index bits.
+						unsigned int render_flags = 0;
+
 						for (unsigned int i = 0; i < 5; ++i)
+						{
 							if ((render_flags_mask & 1 << (5 - i - 1)) != 0)
-								bits.Push((value & 1 << (16 - i - 1)) != 0);
+							{
+								render_flags <<= 1;
+								render_flags |= (value & 1 << (16 - i - 1)) != 0;
+							}
+						}
 
-						// Push the tile index bits.
+						bits.Push(render_flags, total_render_flag_bits);
 						bits.Push(value, inline_value_length);
 					};
 
@@ -334,6 +338,8 @@ namespace ClownLZSS
 					input += run.length * bytes_per_value;
 				}
 
+				std::free(run_lengths);
+
 				// Write terminator pattern.
 				bits.Push(7, 3);
 				bits.Push(0xF, 4);
@@ -356,6 +362,7 @@ namespace ClownLZSS
 		if (output_wrapped.Distance(start) % 2 != 0)
 			output_wrapped.Write(0);
 
+		output_wrapped.Finish();
 		return success;
 	}
 
@@ -365,7 +372,71 @@ namespace ClownLZSS
 		using namespace Internal;
 
 		CompressorOutput output_wrapped(std::forward<T>(output));
-		return ModuledCompressionWrapper<2, Endian::Big>(data, data_size, output_wrapped, Enigma::Compress, module_size, 2);
+		const bool success = ModuledCompressionWrapper<2, Endian::Big>(data, data_size, output_wrapped, Enigma::Compress, module_size, 2);
+		output_wrapped.Finish();
+		return success;
+	}
+
+	constexpr std::size_t EnigmaCompressBound(const std::size_t data_size)
+	{
+		// At worst, every word is an inline copy of one value, which takes 3 + 4 + 16 bits.
+		// On top of that is the header, the terminator, the final partial byte, and the padding to an even size.
+		return 6 + ((data_size + 1) / 2 * (3 + 4 + 16) + 3 + 4 + 7) / 8 + 1 + 1;
+	}
+
+	constexpr std::size_t ModuledEnigmaCompressBound(const std::size_t data_size, const std::size_t module_size)
+	{
+		return Internal::ModuledCompressBound<2>(data_size, module_size, 2, EnigmaCompressBound);
+	}
+
+	inline bool EnigmaCompressedSize(const unsigned char* const data, const std::size_t data_size, std::size_t &compressed_size)
+	{
+		using namespace Internal;
+
+		return MeasureCompressedSize(compressed_size, [&](auto &output)
+		{
+			const bool success = Enigma::Compress(data, data_size, output);
+
+			if (output.Tell() % 2 != 0)
+				output.Write(0);
+
+			return success;
+		});
+	}
+
+	inline bool ModuledEnigmaCompressedSize(const unsigned char* const data, const std::size_t data_size, std::size_t &compressed_size, const std::size_t module_size)
+	{
+		using namespace Internal;
+
+		return MeasureCompressedSize(compressed_size, [&](auto &output)
+		{
+			return ModuledCompressionWrapper<2, Endian::Big>(data, data_size, output, Enigma::Compress, module_size, 2);
+		});
+	}
+
+	inline bool EnigmaCompress(const unsigned char* const data, const std::size_t data_size, const std::span<unsigned char> output, std::size_t &compressed_size)
+	{
+		using namespace Internal;
+
+		return CompressIntoSpan(output, compressed_size, [&](auto &output_wrapped)
+		{
+			const bool success = Enigma::Compress(data, data_size, output_wrapped);
+
+			if (output_wrapped.Tell() % 2 != 0)
+				output_wrapped.Write(0);
+
+			return success;
+		});
+	}
+
+	inline bool ModuledEnigmaCompress(const unsigned char* const data, const std::size_t data_size, const std::span<unsigned char> output, std::size_t &compressed_size, const std::size_t module_size)
+	{
+		using namespace Internal;
+
+		return CompressIntoSpan(output, compressed_size, [&](auto &output_wrapped)
+		{
+			return ModuledCompressionWrapper<2, Endian::Big>(data, data_size, output_wrapped, Enigma::Compress, module_size, 2);
+		});
 	}
 }
 
@@ -17,6 +17,7 @@ PERFORMANCE OF THIS SOFTWARE.
 #define CLOWNLZSS_COMPRESSORS_FAXMAN_H
 
 #include <algorithm>
+#include <span>
 #include <utility>
 
 #include "../bitfield.h"
@@ -25,6 +26,8 @@ PERFORMANCE OF THIS SOFTWARE.
 
 namespace ClownLZSS
 {
+	inline constexpr MatchSearch faxman_match_search = {-1, 0x1F + 3, 0x800, 1};
+
 	namespace Internal
 	{
 		namespace Faxman
@@ -71,23 +74,12 @@ namespace ClownLZSS
 				}
 			}
 
+			// Also counts the descriptor bits, which the header needs.
 			template<typename T>
-			bool Compress(const unsigned char* const data, const std::size_t data_size, CompressorOutput<T> &output)
+			bool EncodeMatches(const unsigned char* const data, const Matches &matches, const std::size_t total_matches, T &output, unsigned int &descriptor_bits_total)
 			{
-				// Produce a series of LZSS compression matches.
-				ClownLZSS::Matches matches;
-				std::size_t total_matches;
-				if (!ClownLZSS::FindOptimalMatches(-1, 0x1F + 3, 0x800, FindExtraMatches, 1 + 8, GetMatchCost, data, 1, data_size, &matches, &total_matches, nullptr))
-					return false;
-
-				// Track the location of the header...
-				const auto header_position = output.Tell();
-
-				// ...and insert a placeholder there.
-				output.WriteLE16(0);
-
-				DescriptorFieldWriter<decltype(output)> descriptor_bits(output);
-				unsigned int descriptor_bits_total = 0;
+				DescriptorFieldWriter<T> descriptor_bits(output);
+				descriptor_bits_total = 0;
 
 				const auto PushDescriptorBit = [&](const bool value)
 				{
@@ -101,7 +93,7 @@ namespace ClownLZSS
 					if (CLOWNLZSS_MATCH_IS_LITERAL(match))
 					{
 						PushDescriptorBit(1);
-						output.Write(data[match->destination]);
+						descriptor_bits.Write(data[match->destination]);
 					}
 					else
 					{
@@ -113,7 +105,7 @@ namespace ClownLZSS
 						{
 							PushDescriptorBit(0);
 							PushDescriptorBit(0);
-							output.Write(offset & 0xFF);
+							descriptor_bits.Write(offset & 0xFF);
 							PushDescriptorBit(((length - 2) & 2) != 0);
 							PushDescriptorBit(((length - 2) & 1) != 0);
 						}
@@ -121,25 +113,42 @@ namespace ClownLZSS
 						{
 							PushDescriptorBit(0);
 							PushDescriptorBit(1);
-							output.Write((distance - 1) & 0xFF);
-							output.Write((((distance - 1) & 0x700) >> 3) | (length - 3));
+							descriptor_bits.Write((distance - 1) & 0xFF);
+							descriptor_bits.Write((((distance - 1) & 0x700) >> 3) | (length - 3));
 						}
 					}
 				}
 
-				// Grab the current position for later.
-				const auto end_position = output.Tell();
+				return descriptor_bits.Finish();
+			}
 
-				// Rewind to the header...
-				output.Seek(header_position);
+			template<typename T>
+			bool Compress(const unsigned char* const data, const std::size_t data_size, CompressorOutput<T> &output, const MatchCandidates* const candidates)
+			{
+				// Produce a series of LZSS compression matches.
+				ClownLZSS::Matches matches;
+				std::size_t total_matches;
+				if (!ClownLZSS::FindOptimalMatches(candidates, faxman_match_search, FindExtraMatches, 1 + 8, GetMatchCost, data, data_size, &matches, &total_matches, nullptr))
+					return false;
+
+				[[maybe_unused]] const EncodingTimer encoding_timer;
+
+				// The header contains the number of descriptor bits, so work that out before writing anything.
+				SizeCounter dummy_output;
+				unsigned int descriptor_bits_total;
+
+				if (!EncodeMatches(data, matches, total_matches, dummy_output, descriptor_bits_total))
+					return false;
 
-				// ...and complete it.
 				output.WriteLE16(descriptor_bits_total);
 
-				// Seek back to the end of the file just as the caller might expect us to do.
-				output.Seek(end_position);
+				return EncodeMatches(data, matches, total_matches, output, descriptor_bits_total);
+			}
 
-				return true;
+			template<typename T>
+			bool Compress(const unsigned char* const data, const std::size_t data_size, CompressorOutput<T> &output)
+			{
+				return Compress(data, data_size, output, nullptr);
 			}
 		}
 	}
@@ -150,7 +159,20 @@ namespace ClownLZSS
 		using namespace Internal;
 
 		CompressorOutput output_wrapped(std::forward<T>(output));
-		return Faxman::Compress(data, data_size, output_wrapped);
+		const bool success = Faxman::Compress(data, data_size, output_wrapped);
+		output_wrapped.Finish();
+		return success;
+	}
+
+	template<typename T>
+	bool FaxmanCompress(const MatchCandidates &candidates, T &&output)
+	{
+		using namespace Internal;
+
+		CompressorOutput output_wrapped(std::forward<T>(output));
+		const bool success = Faxman::Compress(candidates.Get().data, candidates.Get().total_values * candidates.Get().bytes_per_value, output_wrapped, &candidates);
+		output_wrapped.Finish();
+		return success;
 	}
 
 	template<typename T>
@@ -159,7 +181,78 @@ namespace ClownLZSS
 		using namespace Internal;
 
 		CompressorOutput output_wrapped(std::forward<T>(output));
-		return ModuledCompressionWrapper<2, Endian::Big>(data, data_size, output_wrapped, Faxman::Compress, module_size, 2);
+		const bool success = ModuledCompressionWrapper<2, Endian::Big>(data, data_size, output_wrapped, Faxman::Compress, module_size, 2);
+		output_wrapped.Finish();
+		return success;
+	}
+
+	template<typename T>
+	bool ModuledFaxmanCompress(const MatchCandidates &candidates, T &&output, const std::size_t module_size)
+	{
+		using namespace Internal;
+
+		CompressorOutput output_wrapped(std::forward<T>(output));
+		const bool success = ModuledCompressionWrapper<2, Endian::Big>(candidates.Get().data, candidates.Get().total_values * candidates.Get().bytes_per_value, output_wrapped, Faxman::Compress, module_size, 2, &candidates);
+		output_wrapped.Finish();
+		return success;
+	}
+
+	constexpr std::size_t FaxmanCompressBound(const std::size_t data_size)
+	{
+		// The header holds the number of descriptor bits.
+		return 2 + Internal::LiteralsBound(data_size, 1 + 8, 0, 1);
+	}
+
+	constexpr std::size_t ModuledFaxmanCompressBound(const std::size_t data_size, const std::size_t module_size)
+	{
+		return Internal::ModuledCompressBound<2>(data_size, module_size, 2, FaxmanCompressBound);
+	}
+
+	inline bool FaxmanCompressedSize(const unsigned char* const data, const std::size_t data_size, std::size_t &compressed_size)
+	{
+		using namespace Internal;
+
+		return MeasureCompressedSize(compressed_size, [&](auto &output)
+		{
+			return Faxman::Compress(data, data_size, output);
+		});
+	}
+
+	inline bool ModuledFaxmanCompressedSize(const unsigned char* const data, const std::size_t data_size, std::size_t &compressed_size, const std::size_t module_size)
+	{
+		using namespace Internal;
+
+		return MeasureCompressedSize(compressed_size, [&](auto &output)
+		{
+			return ModuledCompressionWrapper<2, Endian::Big>(data, data_size, output, Faxman::Compress, module_size, 2);
+		});
+	}
+
+	inline bool FaxmanEstimateCompressedSize(const unsigned char* const data, const std::size_t data_size, CompressedSizeEstimate &estimate)
+	{
+		using namespace Internal;
+
+		return EstimateCompressedSize(faxman_match_search, 1 + 8, Faxman::GetMatchCost, data, data_size, 0, 2, estimate, nullptr);
+	}
+
+	inline bool FaxmanCompress(const unsigned char* const data, const std::size_t data_size, const std::span<unsigned char> output, std::size_t &compressed_size)
+	{
+		using namespace Internal;
+
+		return CompressIntoSpan(output, compressed_size, [&](auto &output_wrapped)
+		{
+			return Faxman::Compress(data, data_size, output_wrapped);
+		});
+	}
+
+	inline bool ModuledFaxmanCompress(const unsigned char* const data, const std::size_t data_size, const std::span<unsigned char> output, std::size_t &compressed_size, const std::size_t module_size)
+	{
+		using namespace Internal;
+
+		return CompressIntoSpan(output, compressed_size, [&](auto &output_wrapped)
+		{
+			return ModuledCompressionWrapper<2, Endian::Big>(data, data_size, output_wrapped, Faxman::Compress, module_size, 2);
+		});
 	}
 }
 
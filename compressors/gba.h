@@ -19,6 +19,7 @@ PERFORMANCE OF THIS SOFTWARE.
 #include <cassert>
 #include <cstddef>
 #include <ranges>
+#include <span>
 
 #include "../bitfield.h"
 #include "clownlzss.h"
@@ -46,6 +47,7 @@ namespace ClownLZSS
 				inline constexpr auto maximum_encoded_offset = 0xfffu;
 				inline constexpr auto module_header_size = 4;
 				inline constexpr auto module_alignment = 4;
+				inline constexpr MatchSearch match_search = {filler_value, maximum_match_length, maximum_match_distance, bytes_per_value};
 			}
 
 			template<typename T>
@@ -77,26 +79,14 @@ namespace ClownLZSS
 			}
 
 			template<typename T>
-			auto ReserveSpaceForHeader(CompressorOutput<T> &output)
-			{
-				const auto header_position = output.Tell();
-				output.WriteLE16(0);
-				output.WriteLE16(0);
-				return header_position;
-			}
-
-			template<typename T>
-			void WriteHeader(const auto header_position, const std::size_t data_size, CompressorOutput<T> &output)
+			void WriteHeader(const std::size_t data_size, CompressorOutput<T> &output)
 			{
 				using namespace Compressor;
 
-				const auto old_position = output.Tell();
-				output.Seek(header_position);
 				output.Write(bios_compression_type);
 				output.Write(data_size & 255);
 				output.Write((data_size >> 8) & 255);
 				output.Write((data_size >> 16) & 255);
-				output.Seek(old_position);
 			}
 
 			template<typename T>
@@ -126,7 +116,7 @@ namespace ClownLZSS
 			}
 
 			template<typename T>
-			void EncodeMatches(const unsigned char* const data, const Matches& matches, std::size_t total_matches, CompressorOutput<T> &output)
+			bool EncodeMatches(const unsigned char* const data, const Matches& matches, std::size_t total_matches, CompressorOutput<T> &output)
 			{
 				DescriptorFieldWriter<decltype(output)> descriptor_bits(output);
 				for (const auto& match : std::ranges::subrange(&matches[0], &matches[total_matches]))
@@ -134,30 +124,37 @@ namespace ClownLZSS
 					if (CLOWNLZSS_MATCH_IS_LITERAL(&match))
 					{
 						descriptor_bits.Push(0);
-						output.Write(data[match.destination]);
+						descriptor_bits.Write(data[match.destination]);
 					}
 					else
 					{
 						descriptor_bits.Push(1);
-						output.WriteLE16(EncodeMatch(match));
+						descriptor_bits.WriteLE16(EncodeMatch(match));
 					}
 				}
+
+				return descriptor_bits.Finish();
 			}
 
 			template<typename T>
-			bool Compress(const unsigned char* const data, const std::size_t data_size, auto match_cost_callback, CompressorOutput<T> &output)
+			bool Compress(const unsigned char* const data, const std::size_t data_size, auto match_cost_callback, CompressorOutput<T> &output, const MatchCandidates* const candidates)
 			{
 				using namespace Compressor;
 
 				// Produce a series of LZSS compression matches.
 				ClownLZSS::Matches matches;
 				std::size_t total_matches;
-				if (!ClownLZSS::FindOptimalMatches(filler_value, maximum_match_length, maximum_match_distance, nullptr, literal_cost, match_cost_callback, data, bytes_per_value, data_size / bytes_per_value, &matches, &total_matches, nullptr))
+				if (!ClownLZSS::FindOptimalMatches(candidates, match_search, nullptr, literal_cost, match_cost_callback, data, data_size / bytes_per_value, &matches, &total_matches, nullptr))
+					return false;
+
+				[[maybe_unused]] const EncodingTimer encoding_timer;
+
+				const auto header_position = output.Tell();
+				WriteHeader(data_size, output);
+
+				if (!EncodeMatches(data, matches, total_matches, output))
 					return false;
 
-				const auto header_position = ReserveSpaceForHeader(output);
-				EncodeMatches(data, matches, total_matches, output);
-				WriteHeader(header_position, data_size, output);
 				WritePaddingBytes(header_position, output);
 
 				return true;
@@ -166,24 +163,40 @@ namespace ClownLZSS
 			template<typename T>
 			bool Compress(const unsigned char* const data, const std::size_t data_size, CompressorOutput<T> &output)
 			{
-				return Compress(data, data_size, GetMatchCost, output);
+				return Compress(data, data_size, GetMatchCost, output, nullptr);
 			}
 
 			template<typename T>
 			bool CompressVramSafe(const unsigned char* const data, const std::size_t data_size, CompressorOutput<T> &output)
 			{
-				return Compress(data, data_size, GetMatchCostVramSafe, output);
+				return Compress(data, data_size, GetMatchCostVramSafe, output, nullptr);
+			}
+
+			template<typename T>
+			bool Compress(const unsigned char* const data, const std::size_t data_size, CompressorOutput<T> &output, const MatchCandidates* const candidates)
+			{
+				return Compress(data, data_size, GetMatchCost, output, candidates);
+			}
+
+			template<typename T>
+			bool CompressVramSafe(const unsigned char* const data, const std::size_t data_size, CompressorOutput<T> &output, const MatchCandidates* const candidates)
+			{
+				return Compress(data, data_size, GetMatchCostVramSafe, output, candidates);
 			}
 		}
 	}
 
+	inline constexpr MatchSearch gba_match_search = Internal::Gba::Compressor::match_search;
+
 	template<typename T>
 	bool GbaCompress(const unsigned char* const data, const std::size_t data_size, T &&output)
 	{
 		using namespace Internal;
 
 		CompressorOutput output_wrapped(std::forward<T>(output));
-		return Gba::Compress(data, data_size, output_wrapped);
+		const bool success = Gba::Compress(data, data_size, output_wrapped);
+		output_wrapped.Finish();
+		return success;
 	}
 
 	template<typename T>
@@ -192,7 +205,31 @@ namespace ClownLZSS
 		using namespace Internal;
 
 		CompressorOutput output_wrapped(std::forward<T>(output));
-		return Gba::CompressVramSafe(data, data_size, output_wrapped);
+		const bool success = Gba::CompressVramSafe(data, data_size, output_wrapped);
+		output_wrapped.Finish();
+		return success;
+	}
+
+	template<typename T>
+	bool GbaCompress(const MatchCandidates &candidates, T &&output)
+	{
+		using namespace Internal;
+
+		CompressorOutput output_wrapped(std::forward<T>(output));
+		const bool success = Gba::Compress(candidates.Get().data, candidates.Get().total_values, Gba::GetMatchCost, output_wrapped, &candidates);
+		output_wrapped.Finish();
+		return success;
+	}
+
+	template<typename T>
+	bool GbaVramSafeCompress(const MatchCandidates &candidates, T &&output)
+	{
+		using namespace Internal;
+
+		CompressorOutput output_wrapped(std::forward<T>(output));
+		const bool success = Gba::Compress(candidates.Get().data, candidates.Get().total_values, Gba::GetMatchCostVramSafe, output_wrapped, &candidates);
+		output_wrapped.Finish();
+		return success;
 	}
 
 	template<typename T>
@@ -201,7 +238,20 @@ namespace ClownLZSS
 		using namespace Internal;
 
 		CompressorOutput output_wrapped(std::forward<T>(output));
-		return ModuledCompressionWrapper<Gba::Compressor::module_header_size, Endian::Little>(data, data_size, output_wrapped, Gba::Compress, module_size, Gba::Compressor::module_alignment);
+		const bool success = ModuledCompressionWrapper<Gba::Compressor::module_header_size, Endian::Little>(data, data_size, output_wrapped, Gba::Compress, module_size, Gba::Compressor::module_alignment);
+		output_wrapped.Finish();
+		return success;
+	}
+
+	template<typename T>
+	bool ModuledGbaCompress(const MatchCandidates &candidates, T &&output, const std::size_t module_size)
+	{
+		using namespace Internal;
+
+		CompressorOutput output_wrapped(std::forward<T>(output));
+		const bool success = ModuledCompressionWrapper<Gba::Compressor::module_header_size, Endian::Little>(candidates.Get().data, candidates.Get().total_values * candidates.Get().bytes_per_value, output_wrapped, Gba::Compress, module_size, Gba::Compressor::module_alignment, &candidates);
+		output_wrapped.Finish();
+		return success;
 	}
 
 	template<typename T>
@@ -210,7 +260,125 @@ namespace ClownLZSS
 		using namespace Internal;
 
 		CompressorOutput output_wrapped(std::forward<T>(output));
-		return ModuledCompressionWrapper<Gba::Compressor::module_header_size, Endian::Little>(data, data_size, output_wrapped, Gba::CompressVramSafe, module_size, Gba::Compressor::module_alignment);
+		const bool success = ModuledCompressionWrapper<Gba::Compressor::module_header_size, Endian::Little>(data, data_size, output_wrapped, Gba::CompressVramSafe, module_size, Gba::Compressor::module_alignment);
+		output_wrapped.Finish();
+		return success;
+	}
+
+	template<typename T>
+	bool ModuledGbaVramSafeCompress(const MatchCandidates &candidates, T &&output, const std::size_t module_size)
+	{
+		using namespace Internal;
+
+		CompressorOutput output_wrapped(std::forward<T>(output));
+		const bool success = ModuledCompressionWrapper<Gba::Compressor::module_header_size, Endian::Little>(candidates.Get().data, candidates.Get().total_values * candidates.Get().bytes_per_value, output_wrapped, Gba::CompressVramSafe, module_size, Gba::Compressor::module_alignment, &candidates);
+		output_wrapped.Finish();
+		return success;
+	}
+
+	constexpr std::size_t GbaCompressBound(const std::size_t data_size)
+	{
+		// The header holds the size of the uncompressed data, and the whole is padded to a multiple of 4 bytes.
+		return 4 + Internal::LiteralsBound(data_size, 1 + 8, 0, 1) + 3;
+	}
+
+	constexpr std::size_t ModuledGbaCompressBound(const std::size_t data_size, const std::size_t module_size)
+	{
+		return Internal::ModuledCompressBound<Internal::Gba::Compressor::module_header_size>(data_size, module_size, Internal::Gba::Compressor::module_alignment, GbaCompressBound);
+	}
+
+	inline bool GbaCompressedSize(const unsigned char* const data, const std::size_t data_size, std::size_t &compressed_size)
+	{
+		using namespace Internal;
+
+		return MeasureCompressedSize(compressed_size, [&](auto &output)
+		{
+			return Gba::Compress(data, data_size, output);
+		});
+	}
+
+	inline bool GbaVramSafeCompressedSize(const unsigned char* const data, const std::size_t data_size, std::size_t &compressed_size)
+	{
+		using namespace Internal;
+
+		return MeasureCompressedSize(compressed_size, [&](auto &output)
+		{
+			return Gba::CompressVramSafe(data, data_size, output);
+		});
+	}
+
+	inline bool ModuledGbaCompressedSize(const unsigned char* const data, const std::size_t data_size, std::size_t &compressed_size, const std::size_t module_size)
+	{
+		using namespace Internal;
+
+		return MeasureCompressedSize(compressed_size, [&](auto &output)
+		{
+			return ModuledCompressionWrapper<Gba::Compressor::module_header_size, Endian::Little>(data, data_size, output, Gba::Compress, module_size, Gba::Compressor::module_alignment);
+		});
+	}
+
+	inline bool ModuledGbaVramSafeCompressedSize(const unsigned char* const data, const std::size_t data_size, std::size_t &compressed_size, const std::size_t module_size)
+	{
+		using namespace Internal;
+
+		return MeasureCompressedSize(compressed_size, [&](auto &output)
+		{
+			return ModuledCompressionWrapper<Gba::Compressor::module_header_size, Endian::Little>(data, data_size, output, Gba::CompressVramSafe, module_size, Gba::Compressor::module_alignment);
+		});
+	}
+
+	inline bool GbaEstimateCompressedSize(const unsigned char* const data, const std::size_t data_size, CompressedSizeEstimate &estimate)
+	{
+		using namespace Internal;
+
+		return EstimateCompressedSize(gba_match_search, Gba::Compressor::literal_cost, Gba::GetMatchCost, data, data_size / Gba::Compressor::bytes_per_value, 0, 4, estimate, nullptr);
+	}
+
+	inline bool GbaVramSafeEstimateCompressedSize(const unsigned char* const data, const std::size_t data_size, CompressedSizeEstimate &estimate)
+	{
+		using namespace Internal;
+
+		return EstimateCompressedSize(gba_match_search, Gba::Compressor::literal_cost, Gba::GetMatchCostVramSafe, data, data_size / Gba::Compressor::bytes_per_value, 0, 4, estimate, nullptr);
+	}
+
+	inline bool GbaCompress(const unsigned char* const data, const std::size_t data_size, const std::span<unsigned char> output, std::size_t &compressed_size)
+	{
+		using namespace Internal;
+
+		return CompressIntoSpan(output, compressed_size, [&](auto &output_wrapped)
+		{
+			return Gba::Compress(data, data_size, output_wrapped);
+		});
+	}
+
+	inline bool GbaVramSafeCompress(const unsigned char* const data, const std::size_t data_size, const std::span<unsigned char> output, std::size_t &compressed_size)
+	{
+		using namespace Internal;
+
+		return CompressIntoSpan(output, compressed_size, [&](auto &output_wrapped)
+		{
+			return Gba::CompressVramSafe(data, data_size, output_wrapped);
+		});
+	}
+
+	inline bool ModuledGbaCompress(const unsigned char* const data, const std::size_t data_size, const std::span<unsigned char> output, std::size_t &compressed_size, const std::size_t module_size)
+	{
+		using namespace Internal;
+
+		return CompressIntoSpan(output, compressed_size, [&](auto &output_wrapped)
+		{
+			return ModuledCompressionWrapper<Gba::Compressor::module_header_size, Endian::Little>(data, data_size, output_wrapped, Gba::Compress, module_size, Gba::Compressor::module_alignment);
+		});
+	}
+
+	inline bool ModuledGbaVramSafeCompress(const unsigned char* const data, const std::size_t data_size, const std::span<unsigned char> output, std::size_t &compressed_size, const std::size_t module_size)
+	{
+		using namespace Internal;
+
+		return CompressIntoSpan(output, compressed_size, [&](auto &output_wrapped)
+		{
+			return ModuledCompressionWrapper<Gba::Compressor::module_header_size, Endian::Little>(data, data_size, output_wrapped, Gba::CompressVramSafe, module_size, Gba::Compressor::module_alignment);
+		});
 	}
 }
 
@@ -16,6 +16,7 @@ PERFORMANCE OF THIS SOFTWARE.
 #ifndef CLOWNLZSS_COMPRESSORS_KOSINSKI_H
 #define CLOWNLZSS_COMPRESSORS_KOSINSKI_H
 
+#include <span>
 #include <utility>
 
 #include "../bitfield.h"
@@ -24,6 +25,8 @@ PERFORMANCE OF THIS SOFTWARE.
 
 namespace ClownLZSS
 {
+	inline constexpr MatchSearch kosinski_match_search = {-1, 0x100, 0x2000, 1};
+
 	namespace Internal
 	{
 		namespace Kosinski
@@ -44,14 +47,16 @@ namespace ClownLZSS
 			}
 
 			template<typename T>
-			bool Compress(const unsigned char* const data, const std::size_t data_size, CompressorOutput<T> &output)
+			bool Compress(const unsigned char* const data, const std::size_t data_size, CompressorOutput<T> &output, const MatchCandidates* const candidates)
 			{
 				// Produce a series of LZSS compression matches.
 				ClownLZSS::Matches matches;
 				std::size_t total_matches;
-				if (!ClownLZSS::FindOptimalMatches(-1, 0x100, 0x2000, nullptr, 1 + 8, GetMatchCost, data, 1, data_size, &matches, &total_matches, nullptr))
+				if (!ClownLZSS::FindOptimalMatches(candidates, kosinski_match_search, nullptr, 1 + 8, GetMatchCost, data, data_size, &matches, &total_matches, nullptr))
 					return false;
 
+				[[maybe_unused]] const EncodingTimer encoding_timer;
+
 				DescriptorFieldWriter<decltype(output)> descriptor_bits(output);
 
 				// Produce Kosinski-formatted data.
@@ -60,7 +65,7 @@ namespace ClownLZSS
 					if (CLOWNLZSS_MATCH_IS_LITERAL(match))
 					{
 						descriptor_bits.Push(1);
-						output.Write(data[match->destination]);
+						descriptor_bits.Write(data[match->destination]);
 					}
 					else
 					{
@@ -74,22 +79,22 @@ namespace ClownLZSS
 							descriptor_bits.Push(0);
 							descriptor_bits.Push(((length - 2) & 2) != 0);
 							descriptor_bits.Push(((length - 2) & 1) != 0);
-							output.Write(offset & 0xFF);
+							descriptor_bits.Write(offset & 0xFF);
 						}
 						else if (length >= 3 && length <= 9)
 						{
 							descriptor_bits.Push(0);
 							descriptor_bits.Push(1);
-							output.Write(offset & 0xFF);
-							output.Write(((offset >> (8 - 3)) & 0xF8) | ((length - 2) & 7));
+							descriptor_bits.Write(offset & 0xFF);
+							descriptor_bits.Write(((offset >> (8 - 3)) & 0xF8) | ((length - 2) & 7));
 						}
 						else //if (length >= 3)
 						{
 							descriptor_bits.Push(0);
 							descriptor_bits.Push(1);
-							output.Write(offset & 0xFF);
-							output.Write((offset >> (8 - 3)) & 0xF8);
-							output.Write(length - 1);
+							descriptor_bits.Write(offset & 0xFF);
+							descriptor_bits.Write((offset >> (8 - 3)) & 0xF8);
+							descriptor_bits.Write(length - 1);
 						}
 					}
 				}
@@ -97,11 +102,17 @@ namespace ClownLZSS
 				// Add the terminator match.
 				descriptor_bits.Push(0);
 				descriptor_bits.Push(1);
-				output.Write(0x00);
-				output.Write(0xF0);
-				output.Write(0x00);
+				descriptor_bits.Write(0x00);
+				descriptor_bits.Write(0xF0);
+				descriptor_bits.Write(0x00);
+
+				return descriptor_bits.Finish();
+			}
 
-				return true;
+			template<typename T>
+			bool Compress(const unsigned char* const data, const std::size_t data_size, CompressorOutput<T> &output)
+			{
+				return Compress(data, data_size, output, nullptr);
 			}
 		}
 	}
@@ -112,7 +123,20 @@ namespace ClownLZSS
 		using namespace Internal;
 
 		CompressorOutput output_wrapped(std::forward<T>(output));
-		return Kosinski::Compress(data, data_size, output_wrapped);
+		const bool success = Kosinski::Compress(data, data_size, output_wrapped);
+		output_wrapped.Finish();
+		return success;
+	}
+
+	template<typename T>
+	bool KosinskiCompress(const MatchCandidates &candidates, T &&output)
+	{
+		using namespace Internal;
+
+		CompressorOutput output_wrapped(std::forward<T>(output));
+		const bool success = Kosinski::Compress(candidates.Get().data, candidates.Get().total_values * candidates.Get().bytes_per_value, output_wrapped, &candidates);
+		output_wrapped.Finish();
+		return success;
 	}
 
 	template<typename T>
@@ -121,7 +145,77 @@ namespace ClownLZSS
 		using namespace Internal;
 
 		CompressorOutput output_wrapped(std::forward<T>(output));
-		return ModuledCompressionWrapper<2, Endian::Big>(data, data_size, output_wrapped, Kosinski::Compress, module_size, 0x10);
+		const bool success = ModuledCompressionWrapper<2, Endian::Big>(data, data_size, output_wrapped, Kosinski::Compress, module_size, 0x10);
+		output_wrapped.Finish();
+		return success;
+	}
+
+	template<typename T>
+	bool ModuledKosinskiCompress(const MatchCandidates &candidates, T &&output, const std::size_t module_size)
+	{
+		using namespace Internal;
+
+		CompressorOutput output_wrapped(std::forward<T>(output));
+		const bool success = ModuledCompressionWrapper<2, Endian::Big>(candidates.Get().data, candidates.Get().total_values * candidates.Get().bytes_per_value, output_wrapped, Kosinski::Compress, module_size, 0x10, &candidates);
+		output_wrapped.Finish();
+		return success;
+	}
+
+	constexpr std::size_t KosinskiCompressBound(const std::size_t data_size)
+	{
+		return Internal::LiteralsBound(data_size, 1 + 8, 2 + 24, 2);
+	}
+
+	constexpr std::size_t ModuledKosinskiCompressBound(const std::size_t data_size, const std::size_t module_size)
+	{
+		return Internal::ModuledCompressBound<2>(data_size, module_size, 0x10, KosinskiCompressBound);
+	}
+
+	inline bool KosinskiCompressedSize(const unsigned char* const data, const std::size_t data_size, std::size_t &compressed_size)
+	{
+		using namespace Internal;
+
+		return MeasureCompressedSize(compressed_size, [&](auto &output)
+		{
+			return Kosinski::Compress(data, data_size, output);
+		});
+	}
+
+	inline bool ModuledKosinskiCompressedSize(const unsigned char* const data, const std::size_t data_size, std::size_t &compressed_size, const std::size_t module_size)
+	{
+		using namespace Internal;
+
+		return MeasureCompressedSize(compressed_size, [&](auto &output)
+		{
+			return ModuledCompressionWrapper<2, Endian::Big>(data, data_size, output, Kosinski::Compress, module_size, 0x10);
+		});
+	}
+
+	inline bool KosinskiEstimateCompressedSize(const unsigned char* const data, const std::size_t data_size, CompressedSizeEstimate &estimate)
+	{
+		using namespace Internal;
+
+		return EstimateCompressedSize(kosinski_match_search, 1 + 8, Kosinski::GetMatchCost, data, data_size, 2 + 24, 0, estimate, nullptr);
+	}
+
+	inline bool KosinskiCompress(const unsigned char* const data, const std::size_t data_size, const std::span<unsigned char> output, std::size_t &compressed_size)
+	{
+		using namespace Internal;
+
+		return CompressIntoSpan(output, compressed_size, [&](auto &output_wrapped)
+		{
+			return Kosinski::Compress(data, data_size, output_wrapped);
+		});
+	}
+
+	inline bool ModuledKosinskiCompress(const unsigned char* const data, const std::size_t data_size, const std::span<unsigned char> output, std::size_t &compressed_size, const std::size_t module_size)
+	{
+		using namespace Internal;
+
+		return CompressIntoSpan(output, compressed_size, [&](auto &output_wrapped)
+		{
+			return ModuledCompressionWrapper<2, Endian::Big>(data, data_size, output_wrapped, Kosinski::Compress, module_size, 0x10);
+		});
 	}
 }
 
@@ -17,6 +17,7 @@ PERFORMANCE OF THIS SOFTWARE.
 #define CLOWNLZSS_COMPRESSORS_RAGE_H
 
 #include <algorithm>
+#include <span>
 #include <utility>
 
 #include "clownlzss.h"
@@ -24,6 +25,9 @@ PERFORMANCE OF THIS SOFTWARE.
 
 namespace ClownLZSS
 {
+	// Dictionary-matches can be infinite.
+	inline constexpr MatchSearch rage_match_search = {-1, 0xFFFFFFFF, 0x1FFF, 1};
+
 	namespace Internal
 	{
 		namespace Rage
@@ -83,21 +87,8 @@ namespace ClownLZSS
 			}
 
 			template<typename T>
-			bool Compress(const unsigned char* const data, const std::size_t data_size, CompressorOutput<T> &output)
+			void EncodeMatches(const unsigned char* const data, const Matches &matches, const std::size_t total_matches, T &output)
 			{
-				// Produce a series of LZSS compression matches.
-				// Yes, the distance really is 1 lower than usual.
-				ClownLZSS::Matches matches;
-				std::size_t total_matches;
-				if (!ClownLZSS::FindOptimalMatches(-1, 0xFFFFFFFF/*dictionary-matches can be infinite*/, 0x1FFF, FindExtraMatches, 0xFFFFFFF/*dummy*/, GetMatchCost, data, 1, data_size, &matches, &total_matches, nullptr))
-					return false;
-
-				// Track the location of the header...
-				const auto header_position = output.Tell();
-
-				// ...and insert a placeholder there.
-				output.WriteLE16(0);
-
 				// Produce Rage-formatted data.
 				for (ClownLZSS_Match *match = &matches[0]; match != &matches[total_matches]; ++match)
 				{
@@ -110,8 +101,6 @@ namespace ClownLZSS
 
 					if (distance == 0)
 					{
-						std::size_t i;
-
 						// Uncompressed run.
 						if (length > 0x1F)
 						{
@@ -123,8 +112,7 @@ namespace ClownLZSS
 							output.Write(length);
 						}
 
-						for (i = 0; i < length; ++i)
-							output.Write(data[offset + i]);
+						output.WriteBlock(&data[offset], length);
 					}
 					else if ((offset & 0xFFFFFF00) == 0xFFFFFF00)
 					{
@@ -168,21 +156,35 @@ namespace ClownLZSS
 						}
 					}
 				}
+			}
 
-				// Grab the current position for later.
-				const auto end_position = output.Tell();
+			template<typename T>
+			bool Compress(const unsigned char* const data, const std::size_t data_size, CompressorOutput<T> &output, const MatchCandidates* const candidates)
+			{
+				// Produce a series of LZSS compression matches.
+				// Yes, the distance really is 1 lower than usual.
+				ClownLZSS::Matches matches;
+				std::size_t total_matches;
+				if (!ClownLZSS::FindOptimalMatches(candidates, rage_match_search, FindExtraMatches, 0xFFFFFFF/*dummy*/, GetMatchCost, data, data_size, &matches, &total_matches, nullptr))
+					return false;
 
-				// Rewind to the header...
-				output.Seek(header_position);
+				[[maybe_unused]] const EncodingTimer encoding_timer;
 
-				// ...and complete it.
-				output.WriteLE16(end_position - header_position);
+				// The header contains the size of the compressed data (including the header itself), so work that out before writing anything.
+				SizeCounter compressed_size;
+				EncodeMatches(data, matches, total_matches, compressed_size);
+				output.WriteLE16(2 + compressed_size.Tell());
 
-				// Seek back to the end of the file just as the caller might expect us to do.
-				output.Seek(end_position);
+				EncodeMatches(data, matches, total_matches, output);
 
 				return true;
 			}
+
+			template<typename T>
+			bool Compress(const unsigned char* const data, const std::size_t data_size, CompressorOutput<T> &output)
+			{
+				return Compress(data, data_size, output, nullptr);
+			}
 		}
 	}
 
@@ -192,7 +194,20 @@ namespace ClownLZSS
 		using namespace Internal;
 
 		CompressorOutput output_wrapped(std::forward<T>(output));
-		return Rage::Compress(data, data_size, output_wrapped);
+		const bool success = Rage::Compress(data, data_size, output_wrapped);
+		output_wrapped.Finish();
+		return success;
+	}
+
+	template<typename T>
+	bool RageCompress(const MatchCandidates &candidates, T &&output)
+	{
+		using namespace Internal;
+
+		CompressorOutput output_wrapped(std::forward<T>(output));
+		const bool success = Rage::Compress(candidates.Get().data, candidates.Get().total_values * candidates.Get().bytes_per_value, output_wrapped, &candidates);
+		output_wrapped.Finish();
+		return success;
 	}
 
 	template<typename T>
@@ -201,7 +216,71 @@ namespace ClownLZSS
 		using namespace Internal;
 
 		CompressorOutput output_wrapped(std::forward<T>(output));
-		return ModuledCompressionWrapper<2, Endian::Big>(data, data_size, output_wrapped, Rage::Compress, module_size, 2);
+		const bool success = ModuledCompressionWrapper<2, Endian::Big>(data, data_size, output_wrapped, Rage::Compress, module_size, 2);
+		output_wrapped.Finish();
+		return success;
+	}
+
+	template<typename T>
+	bool ModuledRageCompress(const MatchCandidates &candidates, T &&output, const std::size_t module_size)
+	{
+		using namespace Internal;
+
+		CompressorOutput output_wrapped(std::forward<T>(output));
+		const bool success = ModuledCompressionWrapper<2, Endian::Big>(candidates.Get().data, candidates.Get().total_values * candidates.Get().bytes_per_value, output_wrapped, Rage::Compress, module_size, 2, &candidates);
+		output_wrapped.Finish();
+		return success;
+	}
+
+	constexpr std::size_t RageCompressBound(const std::size_t data_size)
+	{
+		// At worst, the data is stored in uncompressed runs, each of which has a two-byte header.
+		return 2 + data_size + (data_size + 0x1FFF - 1) / 0x1FFF * 2;
+	}
+
+	constexpr std::size_t ModuledRageCompressBound(const std::size_t data_size, const std::size_t module_size)
+	{
+		return Internal::ModuledCompressBound<2>(data_size, module_size, 2, RageCompressBound);
+	}
+
+	inline bool RageCompressedSize(const unsigned char* const data, const std::size_t data_size, std::size_t &compressed_size)
+	{
+		using namespace Internal;
+
+		return MeasureCompressedSize(compressed_size, [&](auto &output)
+		{
+			return Rage::Compress(data, data_size, output);
+		});
+	}
+
+	inline bool ModuledRageCompressedSize(const unsigned char* const data, const std::size_t data_size, std::size_t &compressed_size, const std::size_t module_size)
+	{
+		using namespace Internal;
+
+		return MeasureCompressedSize(compressed_size, [&](auto &output)
+		{
+			return ModuledCompressionWrapper<2, Endian::Big>(data, data_size, output, Rage::Compress, module_size, 2);
+		});
+	}
+
+	inline bool RageCompress(const unsigned char* const data, const std::size_t data_size, const std::span<unsigned char> output, std::size_t &compressed_size)
+	{
+		using namespace Internal;
+
+		return CompressIntoSpan(output, compressed_size, [&](auto &output_wrapped)
+		{
+			return Rage::Compress(data, data_size, output_wrapped);
+		});
+	}
+
+	inline bool ModuledRageCompress(const unsigned char* const data, const std::size_t data_size, const std::span<unsigned char> output, std::size_t &compressed_size, const std::size_t module_size)
+	{
+		using namespace Internal;
+
+		return CompressIntoSpan(output, compressed_size, [&](auto &output_wrapped)
+		{
+			return ModuledCompressionWrapper<2, Endian::Big>(data, data_size, output_wrapped, Rage::Compress, module_size, 2);
+		});
 	}
 }
 
@@ -16,6 +16,7 @@ PERFORMANCE OF THIS SOFTWARE.
 #ifndef CLOWNLZSS_COMPRESSORS_ROCKET_H
 #define CLOWNLZSS_COMPRESSORS_ROCKET_H
 
+#include <span>
 #include <utility>
 
 #include "../bitfield.h"
@@ -24,6 +25,8 @@ PERFORMANCE OF THIS SOFTWARE.
 
 namespace ClownLZSS
 {
+	inline constexpr MatchSearch rocket_match_search = {0x20, 0x40, 0x400, 1};
+
 	namespace Internal
 	{
 		namespace Rocket
@@ -37,24 +40,9 @@ namespace ClownLZSS
 			}
 
 			template<typename T>
-			bool Compress(const unsigned char* const data, const std::size_t data_size, CompressorOutput<T> &output)
+			bool EncodeMatches(const unsigned char* const data, const Matches &matches, const std::size_t total_matches, T &output)
 			{
-				// Produce a series of LZSS compression matches.
-				ClownLZSS::Matches matches;
-				std::size_t total_matches;
-				if (!ClownLZSS::FindOptimalMatches(0x20, 0x40, 0x400, nullptr, 1 + 8, GetMatchCost, data, 1, data_size, &matches, &total_matches, nullptr))
-					return false;
-
-				// Write the first part of the header.
-				output.WriteBE16(data_size);
-
-				// Track the location of the second part of the header...
-				const auto header_position = output.Tell();
-
-				// ...and insert a placeholder there.
-				output.WriteBE16(0);
-
-				DescriptorFieldWriter<decltype(output)> descriptor_bits(output);
+				DescriptorFieldWriter<T> descriptor_bits(output);
 
 				// Produce Rocket-formatted data.
 				for (ClownLZSS_Match *match = &matches[0]; match != &matches[total_matches]; ++match)
@@ -62,7 +50,7 @@ namespace ClownLZSS
 					if (CLOWNLZSS_MATCH_IS_LITERAL(match))
 					{
 						descriptor_bits.Push(1);
-						output.Write(data[match->destination]);
+						descriptor_bits.Write(data[match->destination]);
 					}
 					else
 					{
@@ -70,24 +58,42 @@ namespace ClownLZSS
 						const std::size_t length = match->length;
 
 						descriptor_bits.Push(0);
-						output.Write(((offset >> 8) & 3) | ((length - 1) << 2));
-						output.Write(offset & 0xFF);
+						descriptor_bits.Write(((offset >> 8) & 3) | ((length - 1) << 2));
+						descriptor_bits.Write(offset & 0xFF);
 					}
 				}
 
-				// Grab the current position for later.
-				const auto end_position = output.Tell();
+				return descriptor_bits.Finish();
+			}
 
-				// Rewind to the header...
-				output.Seek(header_position);
+			template<typename T>
+			bool Compress(const unsigned char* const data, const std::size_t data_size, CompressorOutput<T> &output, const MatchCandidates* const candidates)
+			{
+				// Produce a series of LZSS compression matches.
+				ClownLZSS::Matches matches;
+				std::size_t total_matches;
+				if (!ClownLZSS::FindOptimalMatches(candidates, rocket_match_search, nullptr, 1 + 8, GetMatchCost, data, data_size, &matches, &total_matches, nullptr))
+					return false;
 
-				// ...and complete it.
-				output.WriteBE16(end_position - header_position - 2);
+				[[maybe_unused]] const EncodingTimer encoding_timer;
 
-				// Seek back to the end of the file just as the caller might expect us to do.
-				output.Seek(end_position);
+				// The header contains the size of the compressed data, so work that out before writing anything.
+				SizeCounter compressed_size;
 
-				return true;
+				if (!EncodeMatches(data, matches, total_matches, compressed_size))
+					return false;
+
+				// Write the header.
+				output.WriteBE16(data_size);
+				output.WriteBE16(compressed_size.Tell());
+
+				return EncodeMatches(data, matches, total_matches, output);
+			}
+
+			template<typename T>
+			bool Compress(const unsigned char* const data, const std::size_t data_size, CompressorOutput<T> &output)
+			{
+				return Compress(data, data_size, output, nullptr);
 			}
 		}
 	}
@@ -98,7 +104,20 @@ namespace ClownLZSS
 		using namespace Internal;
 
 		CompressorOutput output_wrapped(std::forward<T>(output));
-		return Rocket::Compress(data, data_size, output_wrapped);
+		const bool success = Rocket::Compress(data, data_size, output_wrapped);
+		output_wrapped.Finish();
+		return success;
+	}
+
+	template<typename T>
+	bool RocketCompress(const MatchCandidates &candidates, T &&output)
+	{
+		using namespace Internal;
+
+		CompressorOutput output_wrapped(std::forward<T>(output));
+		const bool success = Rocket::Compress(candidates.Get().data, candidates.Get().total_values * candidates.Get().bytes_per_value, output_wrapped, &candidates);
+		output_wrapped.Finish();
+		return success;
 	}
 
 	template<typename T>
@@ -107,7 +126,67 @@ namespace ClownLZSS
 		using namespace Internal;
 
 		CompressorOutput output_wrapped(std::forward<T>(output));
-		return ModuledCompressionWrapper<2, Endian::Big>(data, data_size, output_wrapped, Rocket::Compress, module_size, 2);
+		const bool success = ModuledCompressionWrapper<2, Endian::Big>(data, data_size, output_wrapped, Rocket::Compress, module_size, 2);
+		output_wrapped.Finish();
+		return success;
+	}
+
+	constexpr std::size_t RocketCompressBound(const std::size_t data_size)
+	{
+		// The header holds the uncompressed and compressed sizes.
+		return 4 + Internal::LiteralsBound(data_size, 1 + 8, 0, 1);
+	}
+
+	constexpr std::size_t ModuledRocketCompressBound(const std::size_t data_size, const std::size_t module_size)
+	{
+		return Internal::ModuledCompressBound<2>(data_size, module_size, 2, RocketCompressBound);
+	}
+
+	inline bool RocketCompressedSize(const unsigned char* const data, const std::size_t data_size, std::size_t &compressed_size)
+	{
+		using namespace Internal;
+
+		return MeasureCompressedSize(compressed_size, [&](auto &output)
+		{
+			return Rocket::Compress(data, data_size, output);
+		});
+	}
+
+	inline bool ModuledRocketCompressedSize(const unsigned char* const data, const std::size_t data_size, std::size_t &compressed_size, const std::size_t module_size)
+	{
+		using namespace Internal;
+
+		return MeasureCompressedSize(compressed_size, [&](auto &output)
+		{
+			return ModuledCompressionWrapper<2, Endian::Big>(data, data_size, output, Rocket::Compress, module_size, 2);
+		});
+	}
+
+	inline bool RocketEstimateCompressedSize(const unsigned char* const data, const std::size_t data_size, CompressedSizeEstimate &estimate)
+	{
+		using namespace Internal;
+
+		return EstimateCompressedSize(rocket_match_search, 1 + 8, Rocket::GetMatchCost, data, data_size, 0, 4, estimate, nullptr);
+	}
+
+	inline bool RocketCompress(const unsigned char* const data, const std::size_t data_size, const std::span<unsigned char> output, std::size_t &compressed_size)
+	{
+		using namespace Internal;
+
+		return CompressIntoSpan(output, compressed_size, [&](auto &output_wrapped)
+		{
+			return Rocket::Compress(data, data_size, output_wrapped);
+		});
+	}
+
+	inline bool ModuledRocketCompress(const unsigned char* const data, const std::size_t data_size, const std::span<unsigned char> output, std::size_t &compressed_size, const std::size_t module_size)
+	{
+		using namespace Internal;
+
+		return CompressIntoSpan(output, compressed_size, [&](auto &output_wrapped)
+		{
+			return ModuledCompressionWrapper<2, Endian::Big>(data, data_size, output_wrapped, Rocket::Compress, module_size, 2);
+		});
 	}
 }
 
@@ -17,6 +17,7 @@ PERFORMANCE OF THIS SOFTWARE.
 #define CLOWNLZSS_COMPRESSORS_SAXMAN_H
 
 #include <algorithm>
+#include <span>
 #include <utility>
 
 #include "../bitfield.h"
@@ -25,6 +26,8 @@ PERFORMANCE OF THIS SOFTWARE.
 
 namespace ClownLZSS
 {
+	inline constexpr MatchSearch saxman_match_search = {-1, 0x12, 0x1000, 1};
+
 	namespace Internal
 	{
 		namespace Saxman
@@ -63,15 +66,9 @@ namespace ClownLZSS
 			}
 
 			template<typename T>
-			inline bool Compress(const unsigned char* const data, const std::size_t data_size, CompressorOutput<T> &output)
+			bool EncodeMatches(const unsigned char* const data, const Matches &matches, const std::size_t total_matches, T &output)
 			{
-				// Produce a series of LZSS compression matches.
-				ClownLZSS::Matches matches;
-				std::size_t total_matches;
-				if (!ClownLZSS::FindOptimalMatches(-1, 0x12, 0x1000, FindExtraMatches, 1 + 8, GetMatchCost, data, 1, data_size, &matches, &total_matches, nullptr))
-					return false;
-
-				DescriptorFieldWriter<decltype(output)> descriptor_bits(output);
+				DescriptorFieldWriter<T> descriptor_bits(output);
 
 				// Produce Saxman-formatted data.
 				for (ClownLZSS_Match *match = &matches[0]; match != &matches[total_matches]; ++match)
@@ -79,7 +76,7 @@ namespace ClownLZSS
 					if (CLOWNLZSS_MATCH_IS_LITERAL(match))
 					{
 						descriptor_bits.Push(1);
-						output.Write(data[match->destination]);
+						descriptor_bits.Write(data[match->destination]);
 					}
 					else
 					{
@@ -87,45 +84,55 @@ namespace ClownLZSS
 						const std::size_t length = match->length;
 
 						descriptor_bits.Push(0);
-						output.Write(offset & 0xFF);
-						output.Write(((offset & 0xF00) >> 4) | (length - 3));
+						descriptor_bits.Write(offset & 0xFF);
+						descriptor_bits.Write(((offset & 0xF00) >> 4) | (length - 3));
 					}
 				}
 
-				return true;
+				return descriptor_bits.Finish();
 			}
 
 			template<typename T>
-			inline bool CompressWithHeader(const unsigned char* const data, const std::size_t data_size, T &&output)
+			inline bool Compress(const unsigned char* const data, const std::size_t data_size, CompressorOutput<T> &output, const bool with_header, const MatchCandidates* const candidates)
 			{
-				// Track the location of the header...
-				const auto header_position = output.Tell();
-
-				// ...and insert a placeholder there.
-				output.WriteLE16(0);
-
-				if (!Compress(data, data_size, output))
+				// Produce a series of LZSS compression matches.
+				ClownLZSS::Matches matches;
+				std::size_t total_matches;
+				if (!ClownLZSS::FindOptimalMatches(candidates, saxman_match_search, FindExtraMatches, 1 + 8, GetMatchCost, data, data_size, &matches, &total_matches, nullptr))
 					return false;
 
-				// Grab the current position for later.
-				const auto end_position = output.Tell();
+				[[maybe_unused]] const EncodingTimer encoding_timer;
 
-				// Rewind to the header...
-				output.Seek(header_position);
+				if (with_header)
+				{
+					// The header contains the size of the compressed data, so work that out before writing anything.
+					SizeCounter compressed_size;
+
+					if (!EncodeMatches(data, matches, total_matches, compressed_size))
+						return false;
 
-				// ...and complete it.
-				output.WriteLE16(end_position - header_position - 2);
+					output.WriteLE16(compressed_size.Tell());
+				}
 
-				// Seek back to the end of the file just as the caller might expect us to do.
-				output.Seek(end_position);
+				return EncodeMatches(data, matches, total_matches, output);
+			}
 
-				return true;
+			template<typename T>
+			inline bool CompressWithHeader(const unsigned char* const data, const std::size_t data_size, T &&output)
+			{
+				return Compress(data, data_size, output, true, nullptr);
 			}
 
 			template<typename T>
 			inline bool CompressWithoutHeader(const unsigned char* const data, const std::size_t data_size, T &&output)
 			{
-				return Compress(data, data_size, output);
+				return Compress(data, data_size, output, false, nullptr);
+			}
+
+			template<typename T>
+			inline bool CompressWithHeader(const unsigned char* const data, const std::size_t data_size, T &&output, const MatchCandidates* const candidates)
+			{
+				return Compress(data, data_size, output, true, candidates);
 			}
 		}
 	}
@@ -136,7 +143,9 @@ namespace ClownLZSS
 		using namespace Internal;
 
 		CompressorOutput output_wrapped(std::forward<T>(output));
-		return Saxman::CompressWithoutHeader(data, data_size, output_wrapped);
+		const bool success = Saxman::CompressWithoutHeader(data, data_size, output_wrapped);
+		output_wrapped.Finish();
+		return success;
 	}
 
 	template<typename T>
@@ -145,7 +154,31 @@ namespace ClownLZSS
 		using namespace Internal;
 
 		CompressorOutput output_wrapped(std::forward<T>(output));
-		return Saxman::CompressWithHeader(data, data_size, output_wrapped);
+		const bool success = Saxman::CompressWithHeader(data, data_size, output_wrapped);
+		output_wrapped.Finish();
+		return success;
+	}
+
+	template<typename T>
+	bool SaxmanCompressWithoutHeader(const MatchCandidates &candidates, T &&output)
+	{
+		using namespace Internal;
+
+		CompressorOutput output_wrapped(std::forward<T>(output));
+		const bool success = Saxman::Compress(candidates.Get().data, candidates.Get().total_values, output_wrapped, false, &candidates);
+		output_wrapped.Finish();
+		return success;
+	}
+
+	template<typename T>
+	bool SaxmanCompressWithHeader(const MatchCandidates &candidates, T &&output)
+	{
+		using namespace Internal;
+
+		CompressorOutput output_wrapped(std::forward<T>(output));
+		const bool success = Saxman::Compress(candidates.Get().data, candidates.Get().total_values, output_wrapped, true, &candidates);
+		output_wrapped.Finish();
+		return success;
 	}
 
 	template<typename T>
@@ -154,7 +187,105 @@ namespace ClownLZSS
 		using namespace Internal;
 
 		CompressorOutput output_wrapped(std::forward<T>(output));
-		return ModuledCompressionWrapper<2, Endian::Big>(data, data_size, output_wrapped, Saxman::CompressWithHeader, module_size, 2);
+		const bool success = ModuledCompressionWrapper<2, Endian::Big>(data, data_size, output_wrapped, Saxman::CompressWithHeader, module_size, 2);
+		output_wrapped.Finish();
+		return success;
+	}
+
+	template<typename T>
+	bool ModuledSaxmanCompress(const MatchCandidates &candidates, T &&output, const std::size_t module_size)
+	{
+		using namespace Internal;
+
+		CompressorOutput output_wrapped(std::forward<T>(output));
+		const bool success = ModuledCompressionWrapper<2, Endian::Big>(candidates.Get().data, candidates.Get().total_values * candidates.Get().bytes_per_value, output_wrapped, Saxman::CompressWithHeader, module_size, 2, &candidates);
+		output_wrapped.Finish();
+		return success;
+	}
+
+	constexpr std::size_t SaxmanCompressBound(const std::size_t data_size)
+	{
+		// This includes the optional header, which holds the size of the compressed data.
+		return 2 + Internal::LiteralsBound(data_size, 1 + 8, 0, 1);
+	}
+
+	constexpr std::size_t ModuledSaxmanCompressBound(const std::size_t data_size, const std::size_t module_size)
+	{
+		return Internal::ModuledCompressBound<2>(data_size, module_size, 2, SaxmanCompressBound);
+	}
+
+	inline bool SaxmanCompressedSizeWithoutHeader(const unsigned char* const data, const std::size_t data_size, std::size_t &compressed_size)
+	{
+		using namespace Internal;
+
+		return MeasureCompressedSize(compressed_size, [&](auto &output)
+		{
+			return Saxman::CompressWithoutHeader(data, data_size, output);
+		});
+	}
+
+	inline bool SaxmanCompressedSizeWithHeader(const unsigned char* const data, const std::size_t data_size, std::size_t &compressed_size)
+	{
+		using namespace Internal;
+
+		return MeasureCompressedSize(compressed_size, [&](auto &output)
+		{
+			return Saxman::CompressWithHeader(data, data_size, output);
+		});
+	}
+
+	inline bool ModuledSaxmanCompressedSize(const unsigned char* const data, const std::size_t data_size, std::size_t &compressed_size, const std::size_t module_size)
+	{
+		using namespace Internal;
+
+		return MeasureCompressedSize(compressed_size, [&](auto &output)
+		{
+			return ModuledCompressionWrapper<2, Endian::Big>(data, data_size, output, Saxman::CompressWithHeader, module_size, 2);
+		});
+	}
+
+	inline bool SaxmanEstimateCompressedSizeWithoutHeader(const unsigned char* const data, const std::size_t data_size, CompressedSizeEstimate &estimate)
+	{
+		using namespace Internal;
+
+		return EstimateCompressedSize(saxman_match_search, 1 + 8, Saxman::GetMatchCost, data, data_size, 0, 0, estimate, nullptr);
+	}
+
+	inline bool SaxmanEstimateCompressedSizeWithHeader(const unsigned char* const data, const std::size_t data_size, CompressedSizeEstimate &estimate)
+	{
+		using namespace Internal;
+
+		return EstimateCompressedSize(saxman_match_search, 1 + 8, Saxman::GetMatchCost, data, data_size, 0, 2, estimate, nullptr);
+	}
+
+	inline bool SaxmanCompressWithoutHeader(const unsigned char* const data, const std::size_t data_size, const std::span<unsigned char> output, std::size_t &compressed_size)
+	{
+		using namespace Internal;
+
+		return CompressIntoSpan(output, compressed_size, [&](auto &output_wrapped)
+		{
+			return Saxman::CompressWithoutHeader(data, data_size, output_wrapped);
+		});
+	}
+
+	inline bool SaxmanCompressWithHeader(const unsigned char* const data, const std::size_t data_size, const std::span<unsigned char> output, std::size_t &compressed_size)
+	{
+		using namespace Internal;
+
+		return CompressIntoSpan(output, compressed_size, [&](auto &output_wrapped)
+		{
+			return Saxman::CompressWithHeader(data, data_size, output_wrapped);
+		});
+	}
+
+	inline bool ModuledSaxmanCompress(const unsigned char* const data, const std::size_t data_size, const std::span<unsigned char> output, std::size_t &compressed_size, const std::size_t module_size)
+	{
+		using namespace Internal;
+
+		return CompressIntoSpan(output, compressed_size, [&](auto &output_wrapped)
+		{
+			return ModuledCompressionWrapper<2, Endian::Big>(data, data_size, output_wrapped, Saxman::CompressWithHeader, module_size, 2);
+		});
 	}
 }
 
@@ -16,6 +16,7 @@ PERFORMANCE OF THIS SOFTWARE.
 #ifndef CLOWNLZSS_DECOMPRESSORS_CHAMELEON_H
 #define CLOWNLZSS_DECOMPRESSORS_CHAMELEON_H
 
+#include <cstddef>
 #include <utility>
 
 #include "../bitfield.h"
@@ -33,88 +34,118 @@ namespace ClownLZSS
 			template<typename T>
 			using BitField = BitField::Reader<1, BitField::ReadWhen::BeforePop, BitField::PopWhere::High, BitField::Endian::Big, T>;
 
+			// The descriptor bits of a match, after the bit which marks it as a match.
+			struct Token
+			{
+				unsigned char distance_high_bits = 0;
+				unsigned char count = 0; // 0 means that the count is in the next byte of input.
+				unsigned char total_bits = 0;
+			};
+
+			template<typename T>
+			constexpr Token DecodeToken(const T &Pop)
+			{
+				Token token;
+
+				if (!Pop())
+				{
+					token.count = 2 + Pop();
+				}
+				else
+				{
+					if (Pop())
+						token.distance_high_bits += 1 << 2;
+					if (Pop())
+						token.distance_high_bits += 1 << 1;
+					if (Pop())
+						token.distance_high_bits += 1 << 0;
+
+					if (!Pop())
+					{
+						if (!Pop())
+							token.count = 3;
+						else
+							token.count = 4;
+					}
+					else
+					{
+						if (!Pop())
+							token.count = 5;
+					}
+				}
+
+				return token;
+			}
+
+			// A match can have up to six more descriptor bits, so decoding them with a single lookup saves a lot of
+			// hard-to-predict branching.
+			inline constexpr auto token_table = Internal::BitField::MakeTokenTable<6, Internal::BitField::PopWhere::High, Token>([](const auto &Pop) constexpr {return DecodeToken(Pop);});
+
 			template<typename T1, typename T2>
 			void Decompress(DecompressorInput<T1> &input, DecompressorOutput<T2> &output)
 			{
 				const auto offset = input.ReadBE16();
-				auto descriptor_input = input.MakeSeparate();
-				input += offset;
+				auto descriptor_input = input.MakeSeparate(offset);
 
 				BitField<decltype(descriptor_input)> descriptor_bits(descriptor_input);
 
 				for (;;)
 				{
-					if (descriptor_bits.Pop())
-					{
-						output.Write(input.Read());
-					}
-					else
+					const bool done = StepWithinBounds(input, output, 2, 1, [&](auto &&input, auto &&output)
 					{
-						unsigned int distance = input.Read();
-						unsigned int count;
-
-						if (!descriptor_bits.Pop())
+						if (descriptor_bits.Pop())
 						{
-							count = 2 + descriptor_bits.Pop();
+							output.Write(input.Read());
 						}
 						else
 						{
-							if (descriptor_bits.Pop())
-								distance += 1 << 10;
-							if (descriptor_bits.Pop())
-								distance += 1 << 9;
-							if (descriptor_bits.Pop())
-								distance += 1 << 8;
-
-							if (!descriptor_bits.Pop())
-							{
-								if (!descriptor_bits.Pop())
-									count = 3;
-								else
-									count = 4;
-							}
+							unsigned int available;
+							Token token = token_table[descriptor_bits.template Peek<6>(available)];
+
+							if (token.total_bits <= available)
+								descriptor_bits.Skip(token.total_bits);
 							else
+								token = DecodeToken([&]() {return descriptor_bits.Pop();}); // The match spans two descriptor fields.
+
+							const unsigned int distance = token.distance_high_bits << 8 | input.Read();
+							unsigned int count = token.count;
+
+							if (count == 0)
 							{
-								if (!descriptor_bits.Pop())
-								{
-									count = 5;
-								}
-								else
-								{
-									count = input.Read();
-
-									if (count < 6)
-										break;
-								}
+								count = input.Read();
+
+								if (count < 6)
+									return true;
 							}
+
+							output.Copy(distance, count);
 						}
 
-						output.Copy(distance, count);
-					}
+						return false;
+					});
+
+					if (done)
+						break;
 				}
 			}
-		}
-	}
-
-	template<typename T1, typename T2>
-	void ChameleonDecompress(T1 &&input, T2 &&output)
-	{
-		using namespace Internal;
 
-		DecompressorInput input_wrapped(std::forward<T1>(input));
-		Chameleon::DecompressorOutput<T2> output_wrapped(std::forward<T2>(output));
-		Chameleon::Decompress(input_wrapped, output_wrapped);
-	}
+			struct Format : public DecompressorFormat
+			{
+				template<typename T>
+				using Output = DecompressorOutput<T>;
 
-	template<typename T1, typename T2>
-	void ModuledChameleonDecompress(T1 &&input, T2 &&output)
-	{
-		using namespace Internal;
+				static constexpr std::size_t module_alignment = 2;
 
-		DecompressorInput input_wrapped(std::forward<T1>(input));
-		Chameleon::DecompressorOutput<T2> output_wrapped(std::forward<T2>(output));
-		ModuledDecompressionWrapper<2, Endian::Big>(input_wrapped, output_wrapped, Chameleon::Decompress, 2);
+				template<typename T1, typename T2>
+				static void Decompress(DecompressorInput<T1> &input, T2 &output)
+				{
+					Chameleon::Decompress(input, output);
+				}
+			};
+		}
 	}
+
+	CLOWNLZSS_DECOMPRESSOR_WRAPPERS(Chameleon, Internal::Chameleon::Format)
 }
 
 #endif // CLOWNLZSS_DECOMPRESSORS_CHAMELEON_H
@@ -19,17 +19,77 @@ PERFORMANCE OF THIS SOFTWARE.
 #include <algorithm>
 #include <array>
 #include <bit>
+#include <concepts>
+#include <cstddef>
+#include <exception>
 #include <iterator>
 #if __STDC_HOSTED__
+	#include <atomic>
+	#include <condition_variable>
 	#include <istream>
+	#include <memory>
+	#include <mutex>
+	#include <optional>
 	#include <ostream>
+	#include <ranges>
+	#include <streambuf>
+	#include <thread>
 #endif
 #include <type_traits>
+#include <utility>
+#if __STDC_HOSTED__
+	#include <vector>
+#endif
 
 #include "../common.h"
 
 namespace ClownLZSS
 {
+	namespace Internal
+	{
+		// Passing this as the input or output type produces a wrapper that refuses to leave the given range,
+		// for decompressing data that cannot be trusted.
+		template<std::random_access_iterator Iterator>
+		struct Bounded
+		{
+			Iterator begin, end;
+		};
+
+		template<typename Iterator>
+		Bounded(Iterator, Iterator) -> Bounded<Iterator>;
+
+		template<typename T>
+		inline constexpr bool is_bounded = false;
+
+		template<typename Iterator>
+		inline constexpr bool is_bounded<Bounded<Iterator>> = true;
+
+		// Thrown by the bounded wrappers when the data tries to leave its range.
+		struct OutOfBounds {};
+
+		template<typename Input>
+		class UncheckedInput;
+
+		template<typename Output>
+		class UncheckedOutput;
+
+		// Returns whether 'function' stayed within its bounds.
+		template<typename Function>
+		bool CatchOutOfBounds(const Function &function)
+		{
+			try
+			{
+				function();
+			}
+			catch (const OutOfBounds&)
+			{
+				return false;
+			}
+
+			return true;
+		}
+	}
+
 	// DecompressorInputBase
 
 	template<typename T, typename Derived>
@@ -58,6 +118,30 @@ namespace ClownLZSS
 			return value;
 		}
 
+		template<typename OutputIterator>
+		OutputIterator ReadBlockImplementation(OutputIterator destination, const std::size_t count)
+		{
+			if constexpr(std::random_access_iterator<Iterator>)
+			{
+				// The compiler vectorises this loop by itself, and, unlike 'std::copy_n', it does not
+				// call 'memmove', which is costly for the short runs that these formats tend to have.
+				const auto source = iterator;
+				iterator += count;
+
+				for (std::size_t i = 0; i < count; ++i)
+				{
+					*destination = source[i];
+					++destination;
+				}
+
+				return destination;
+			}
+			else
+			{
+				return Base::ReadBlockImplementation(destination, count);
+			}
+		}
+
 	public:
 		using Internal::InputCommon<Derived>::InputCommon;
 
@@ -71,9 +155,12 @@ namespace ClownLZSS
 			return *this;
 		}
 
-		auto MakeSeparate()
+		// Returns a reader for the next 'size' bytes, and moves this reader past them.
+		auto MakeSeparate(const unsigned int size)
 		{
-			return *this;
+			const auto separate = *this;
+			iterator += size;
+			return separate;
 		}
 
 		friend Base;
@@ -84,82 +171,183 @@ namespace ClownLZSS
 	requires std::is_convertible_v<T&, std::istream&>
 	class DecompressorInputBase<T, Derived> : public Internal::InputCommon<Derived>
 	{
+	public:
+		// Positions are relative to wherever the stream was when this object was created.
+		using pos_type = std::istream::off_type;
+		using difference_type = std::istream::off_type;
+
 	protected:
 		using Base = Internal::InputCommon<Derived>;
 
 		std::istream &input;
 
+		// Calling into the stream for every byte is very slow, so data is read in large blocks
+		// and then served from memory. The position is tracked locally, so that 'Tell' and
+		// 'Distance' never have to query the stream.
+		std::array<char, 0x10000> block;
+		std::size_t block_index = 0;
+		std::size_t block_length = 0;
+		// The stream is always sitting at the position of the end of the block.
+		pos_type block_position = 0;
+
+		void ReadNextBlock()
+		{
+			block_position += block_length;
+			block_index = 0;
+			block_length = input.rdbuf()->sgetn(block.data(), block.size());
+		}
+
 		unsigned char ReadImplementation()
 		{
-			return input.get();
+			if (block_index == block_length)
+			{
+				ReadNextBlock();
+
+				// Mimic 'std::istream::get'.
+				if (block_length == 0)
+				{
+					input.setstate(input.eofbit | input.failbit);
+					return std::istream::traits_type::eof();
+				}
+			}
+
+			return block[block_index++];
 		}
 
-		DecompressorInputBase& AdditionAssignImplementation(const unsigned int value)
+		template<typename OutputIterator>
+		OutputIterator ReadBlockImplementation(OutputIterator destination, std::size_t count)
 		{
-			input.seekg(value, input.cur);
-			return *this;
+			while (count != 0)
+			{
+				if (block_index == block_length)
+				{
+					ReadNextBlock();
+
+					// Let the usual path deal with the end of the stream.
+					if (block_length == 0)
+						return Base::ReadBlockImplementation(destination, count);
+				}
+
+				const std::size_t amount = std::min(count, block_length - block_index);
+
+				destination = std::copy_n(&block[block_index], amount, destination);
+				block_index += amount;
+				count -= amount;
+			}
+
+			return destination;
+		}
+
+		// Returns the unconsumed part of the block to the stream. This requires the stream to be seekable:
+		// if it is not, then the stream is left past the end of the compressed data.
+		void GiveBack()
+		{
+			const std::size_t unconsumed = block_length - block_index;
+
+			block_position += block_index;
+			block_index = block_length = 0;
+
+			if (unconsumed != 0)
+				input.seekg(-static_cast<difference_type>(unconsumed), input.cur);
 		}
 
 	public:
-		class Separate : public DecompressorInputBase<T, Separate>
+		// Formats like Chameleon keep their descriptor fields apart from the rest of their data.
+		// Rather than seek back and forth between the two, the descriptor fields are copied into
+		// memory up-front, so that both can be read sequentially.
+		class Separate : public Internal::InputCommon<Separate>
 		{
 		protected:
-			using Base = DecompressorInputBase<T, Separate>;
+			using Base = Internal::InputCommon<Separate>;
+
+			std::vector<unsigned char> buffer;
+			std::size_t index = 0;
 
-			Base::pos_type position;
+			// Malformed data can ask for more than its header said there would be.
+			void Require(const std::size_t count) const
+			{
+				if (buffer.size() - index < count) [[unlikely]]
+					throw Internal::OutOfBounds();
+			}
 
 			unsigned char ReadImplementation()
 			{
-				const auto previous_position = Base::Tell();
-				Base::Seek(position);
-				const auto value = Base::ReadImplementation();
-				position = Base::Tell();
-				Base::Seek(previous_position);
-				return value;
+				Require(1);
+				return buffer[index++];
 			}
 
-			Separate& AdditionAssignImplementation(const unsigned int value)
+			template<typename OutputIterator>
+			OutputIterator ReadBlockImplementation(const OutputIterator destination, const std::size_t count)
 			{
-				const auto previous_position = Base::Tell();
-				Base::Seek(position);
-				Base::AdditionAssignImplementation(value);
-				position = Base::Tell();
-				Base::Seek(previous_position);
-				return *this;
+				Require(count);
+
+				const auto source = index;
+				index += count;
+				return std::copy_n(buffer.data() + source, count, destination);
 			}
 
 		public:
-			Separate(std::istream &input)
-				: Base::DecompressorInputBase(input)
-				, position(Base::Tell())
-			{}
+			Separate(DecompressorInputBase &input, const unsigned int size)
+				: buffer(size)
+			{
+				std::size_t buffer_index = 0;
+
+				while (buffer_index != size)
+				{
+					if (input.block_index == input.block_length)
+					{
+						input.ReadNextBlock();
+
+						if (input.block_length == 0)
+						{
+							input.input.setstate(input.input.eofbit | input.input.failbit);
+							break;
+						}
+					}
+
+					const std::size_t amount = std::min<std::size_t>(size - buffer_index, input.block_length - input.block_index);
+
+					std::copy(&input.block[input.block_index], &input.block[input.block_index] + amount, &buffer[buffer_index]);
+					buffer_index += amount;
+					input.block_index += amount;
+				}
+			}
 
 			friend Base;
-			friend Internal::InputCommon<Separate>;
 		};
 
-		using pos_type = std::istream::pos_type;
-		using difference_type = std::istream::off_type;
-
 		using Internal::InputCommon<Derived>::InputCommon;
 
 		DecompressorInputBase(std::istream &input)
 			: input(input)
 		{}
 
+		DecompressorInputBase(const DecompressorInputBase &other) = delete;
+		DecompressorInputBase& operator=(const DecompressorInputBase &other) = delete;
+
 		DecompressorInputBase& operator+=(const unsigned int value)
 		{
-			return static_cast<Derived*>(this)->AdditionAssignImplementation(value);
+			Seek(Tell() + value);
+			return *this;
 		}
 
 		pos_type Tell() const
 		{
-			return input.tellg();
+			return block_position + block_index;
 		};
 
 		void Seek(const pos_type &position)
 		{
-			input.seekg(position);
+			if (position >= block_position && position <= block_position + static_cast<difference_type>(block_length))
+			{
+				block_index = position - block_position;
+			}
+			else
+			{
+				input.seekg(position - (block_position + block_length), input.cur);
+				block_position = position;
+				block_index = block_length = 0;
+			}
 		};
 
 		difference_type Distance(const pos_type &first) const
@@ -172,15 +360,84 @@ namespace ClownLZSS
 			return last - first;
 		}
 
-		auto MakeSeparate()
+		// Returns a reader for the next 'size' bytes, and moves this reader past them.
+		auto MakeSeparate(const unsigned int size)
 		{
-			return Separate(input);
+			return Separate(*this, size);
 		}
 
 		friend Base;
 	};
 	#endif
 
+	template<typename T, typename Derived>
+	requires Internal::is_bounded<std::decay_t<T>>
+	class DecompressorInputBase<T, Derived> : public DecompressorInputBase<decltype(std::decay_t<T>::begin), Derived>
+	{
+	protected:
+		using Base = DecompressorInputBase<decltype(std::decay_t<T>::begin), Derived>;
+		using Iterator = Base::Iterator;
+		using Base::iterator;
+
+		Iterator end;
+
+		void Require(const std::size_t total_bytes) const
+		{
+			if (static_cast<std::size_t>(end - iterator) < total_bytes) [[unlikely]]
+				throw Internal::OutOfBounds();
+		}
+
+		unsigned char ReadImplementation()
+		{
+			Require(1);
+			return Base::ReadImplementation();
+		}
+
+		template<typename OutputIterator>
+		OutputIterator ReadBlockImplementation(const OutputIterator destination, const std::size_t count)
+		{
+			Require(count);
+			return Base::ReadBlockImplementation(destination, count);
+		}
+
+		unsigned char ReadUncheckedImplementation()
+		{
+			return Base::ReadImplementation();
+		}
+
+	public:
+		DecompressorInputBase(const std::decay_t<T> &range)
+			: Base(range.begin)
+			, end(range.end)
+		{}
+
+		// Returns whether there are at least 'total_bytes' left to read.
+		bool Has(const std::size_t total_bytes) const
+		{
+			return static_cast<std::size_t>(end - iterator) >= total_bytes;
+		}
+
+		DecompressorInputBase& operator+=(const unsigned int value)
+		{
+			Require(value);
+			Base::operator+=(value);
+			return *this;
+		}
+
+		// Returns a reader for the next 'size' bytes, and moves this reader past them.
+		auto MakeSeparate(const unsigned int size)
+		{
+			Require(size);
+			auto separate = *this;
+			separate.end = iterator + size;
+			iterator += size;
+			return separate;
+		}
+
+		friend Internal::InputCommon<Derived>;
+		friend Internal::UncheckedInput<Derived>;
+	};
+
 	// DecompressorInput
 
 	template<typename T>
@@ -198,171 +455,1493 @@ namespace ClownLZSS
 		using DecompressorInputBase<T, DecompressorInput<T>>::DecompressorInputBase;
 	};
 
-	#if __STDC_HOSTED__
 	template<typename T>
-	requires std::is_convertible_v<T&, std::istream&>
+	requires Internal::is_bounded<std::decay_t<T>>
 	class DecompressorInput<T> : public DecompressorInputBase<T, DecompressorInput<T>>
 	{
 	public:
 		using DecompressorInputBase<T, DecompressorInput<T>>::DecompressorInputBase;
 	};
-	#endif
-
-	// DecompressorOutputBasic
-
-	template<typename T>
-	class DecompressorOutputBasic : public Internal::OutputCommon<T, DecompressorOutputBasic<T>>
-	{
-	public:
-		DecompressorOutputBasic(T output);
-	};
-
-	template<typename T>
-	requires std::random_access_iterator<std::decay_t<T>>
-	class DecompressorOutputBasic<T> : public Internal::OutputCommon<T, DecompressorOutputBasic<T>>
-	{
-	public:
-		using Internal::OutputCommon<T, DecompressorOutputBasic<T>>::OutputCommon;
-	};
 
 	#if __STDC_HOSTED__
 	template<typename T>
-	requires std::is_convertible_v<T&, std::ostream&>
-	class DecompressorOutputBasic<T> : public Internal::OutputCommon<T, DecompressorOutputBasic<T>>
-	{
-	public:
-		using Internal::OutputCommon<T, DecompressorOutputBasic<T>>::OutputCommon;
-	};
-	#endif
-
-	// DecompressorOutput
-
-	template<typename T, unsigned int dictionary_size, unsigned int maximum_copy_length, int filler_value = -1>
-	class DecompressorOutput : public Internal::OutputCommon<T, DecompressorOutput<T, dictionary_size, maximum_copy_length, filler_value>>
-	{
-	public:
-		DecompressorOutput(T output);
-	};
-
-	template<typename T, unsigned int dictionary_size, unsigned int maximum_copy_length, int filler_value>
-	requires Internal::random_access_input_output_iterator<std::decay_t<T>>
-	class DecompressorOutput<T, dictionary_size, maximum_copy_length, filler_value> : public Internal::OutputCommon<T, DecompressorOutput<T, dictionary_size, maximum_copy_length, filler_value>>
+	requires std::is_convertible_v<T&, std::istream&>
+	class DecompressorInput<T> : public DecompressorInputBase<T, DecompressorInput<T>>
 	{
 	protected:
-		using Base = Internal::OutputCommon<T, DecompressorOutput<T, dictionary_size, maximum_copy_length, filler_value>>;
-		using Iterator = Base::Iterator;
-		using Base::iterator;
+		using Base = DecompressorInputBase<T, DecompressorInput<T>>;
 
-		Iterator start_iterator;
+		const int uncaught_exceptions = std::uncaught_exceptions();
+		bool finished = false;
 
-		void ResetImplementation()
+		// Leave the stream just after the compressed data, so that the caller can read whatever follows it.
+		void FinishImplementation()
 		{
-			if constexpr(filler_value != -1)
-				start_iterator = iterator;
+			finished = true;
+			Base::GiveBack();
 		}
 
 	public:
 		using Base::Base;
 
-		void Copy(const unsigned int distance, const unsigned int count)
-		{
-			if constexpr(filler_value != -1)
-			{
-				const unsigned int limit = Base::Distance(start_iterator);
-				const unsigned int capped_distance = std::min(distance, limit);
-				const unsigned int fill_amount = distance - capped_distance;
+		DecompressorInput(const DecompressorInput &other) = delete;
+		DecompressorInput& operator=(const DecompressorInput &other) = delete;
 
-				Base::Fill(filler_value, fill_amount);
-				std::copy(iterator - distance + fill_amount, iterator - distance + count, iterator);
-			}
-			else
+		// Destructors must not throw, so a failure to seek here is ignored. Call 'Finish' to have it reported.
+		~DecompressorInput()
+		{
+			if (!finished && std::uncaught_exceptions() == uncaught_exceptions)
 			{
-				std::copy(iterator - distance, iterator - distance + count, iterator);
+				try
+				{
+					Base::GiveBack();
+				}
+				catch (...)
+				{}
 			}
-
-			iterator += count;
 		}
 
 		friend Base::Base;
 	};
+	#endif
 
-	#if __STDC_HOSTED__
-	template<typename T, unsigned int dictionary_size, unsigned int maximum_copy_length, int filler_value>
-	requires std::is_convertible_v<T&, std::ostream&>
-	class DecompressorOutput<T, dictionary_size, maximum_copy_length, filler_value> : public Internal::OutputCommon<T, DecompressorOutput<T, dictionary_size, maximum_copy_length, filler_value>>
+	namespace Internal
 	{
-	protected:
-		using Base = Internal::OutputCommon<T, DecompressorOutput<T, dictionary_size, maximum_copy_length, filler_value>>;
-		using Base::output;
+		// Dictionary matches are simply added to the count rather than performed,
+		// so finding the size this way is much quicker than decompressing.
+		template<typename Derived>
+		class DiscardingOutput : public OutputCommonBase<Derived>
+		{
+		protected:
+			using Base = OutputCommonBase<Derived>;
 
-		// Pad this to the nearest power-of-two so that the modulos are faster.
-		static constexpr auto padded_dictionary_size = std::bit_ceil(dictionary_size);
+			std::size_t size = 0;
 
-		std::array<char, padded_dictionary_size + maximum_copy_length - 1> buffer;
-		unsigned int index = 0;
+			void WriteImplementation([[maybe_unused]] const unsigned char value)
+			{
+				++size;
+			}
 
-		void WriteToBuffer(const unsigned char value)
-		{
-			buffer[index] = value;
+			void WriteBlockImplementation([[maybe_unused]] const unsigned char* const data, const std::size_t data_size)
+			{
+				size += data_size;
+			}
 
-			// A lovely little trick that is borrowed from Okumura's LZSS decompressor...
-			if (index < maximum_copy_length - 1)
-				buffer[padded_dictionary_size + index] = value;
+			void FillImplementation([[maybe_unused]] const unsigned char value, const std::size_t count)
+			{
+				size += count;
+			}
 
-			index = (index + 1) % padded_dictionary_size;
-		}
+			template<typename Input>
+			void CopyFromImplementation(Input &input, const std::size_t count)
+			{
+				input += count;
+				size += count;
+			}
 
-		void WriteImplementation(const unsigned char value)
-		{
-			WriteToBuffer(value);
-			Base::WriteImplementation(value);
-		}
+		public:
+			using pos_type = std::size_t;
+			using difference_type = std::ptrdiff_t;
 
-		void ResetImplementation()
-		{
-			if constexpr(filler_value != -1)
-				buffer.fill(filler_value);
-		}
+			void Copy([[maybe_unused]] const unsigned int distance, const unsigned int count)
+			{
+				size += count;
+			}
 
-	public:
-		using Base::Base;
+			pos_type Tell() const
+			{
+				return size;
+			}
 
-		void Copy(const unsigned int distance, const unsigned int count)
+			difference_type Distance(const pos_type &first) const
+			{
+				return Distance(first, Tell());
+			}
+
+			static difference_type Distance(const pos_type &first, const pos_type &last)
+			{
+				return last - first;
+			}
+
+			friend Base;
+		};
+
+		// Adds range checks to an iterator-based output.
+		template<typename Base, typename Derived>
+		class BoundedOutput : public Base
 		{
-			const unsigned int source_index = (index - distance + padded_dictionary_size) % padded_dictionary_size;
-			const unsigned int destination_index = index;
+		protected:
+			using Iterator = Base::Iterator;
+			using Base::iterator;
 
-			for (unsigned int i = 0; i < count; ++i)
-				WriteToBuffer(buffer[source_index + i]);
+			Iterator begin, end;
 
-			output.write(&buffer[destination_index], count);
-		}
+			void Require(const std::size_t total_bytes) const
+			{
+				if (static_cast<std::size_t>(end - iterator) < total_bytes) [[unlikely]]
+					throw OutOfBounds();
+			}
 
-		friend Base::Base;
-	};
-	#endif
+			void WriteImplementation(const unsigned char value)
+			{
+				Require(1);
+				Base::WriteImplementation(value);
+			}
 
-	namespace Internal
-	{
-		template<unsigned int total_bytes, Endian endian, typename T1, typename T2>
-		void ModuledDecompressionWrapper(DecompressorInput<T1> &input, T2 &output, void (* const decompression_function)(DecompressorInput<T1> &input, T2 &output), const std::size_t module_alignment)
-		{
-			const auto header = input.template Read<total_bytes, endian>();
+			void WriteBlockImplementation(const unsigned char* const data, const std::size_t size)
+			{
+				Require(size);
+				Base::WriteBlockImplementation(data, size);
+			}
 
-			const auto input_start_position = input.Tell();
+			void FillImplementation(const unsigned char value, const std::size_t count)
+			{
+				Require(count);
 
-			const unsigned long total_modules = (header + (0x1000 - 1)) / 0x1000; // Round up.
+				for (std::size_t i = 0; i < count; ++i)
+				{
+					*iterator = value;
+					++iterator;
+				}
+			}
 
-			for (unsigned long i = 0; i < total_modules - 1; ++i)
+			template<typename Input>
+			void CopyFromImplementation(Input &input, const std::size_t count)
 			{
-				decompression_function(input, output);
-				input += (module_alignment - (input.Distance(input_start_position) % module_alignment)) % module_alignment;
-				output.Reset();
+				Require(count);
+				Base::CopyFromImplementation(input, count);
 			}
 
-			decompression_function(input, output);
-		}
-	}
-}
+			void WriteUncheckedImplementation(const unsigned char value)
+			{
+				Base::WriteImplementation(value);
+			}
+
+		public:
+			BoundedOutput(const Bounded<Iterator> &range)
+				: Base(range.begin)
+				, begin(range.begin)
+				, end(range.end)
+			{}
+
+			// Returns whether there is room for at least 'total_bytes' more.
+			bool Has(const std::size_t total_bytes) const
+			{
+				return static_cast<std::size_t>(end - iterator) >= total_bytes;
+			}
+
+			friend OutputCommonBase<Derived>;
+			friend UncheckedOutput<Derived>;
+		};
+	}
+
+	// Passing a callable of this form as the output produces an output that hands the decompressed data to it in blocks,
+	// straight out of the dictionary, rather than writing it anywhere. This way, the data can be hashed, uploaded, or sent
+	// to a device of some kind as it is decompressed, without needing memory for any more than the dictionary.
+	template<typename T>
+	concept decompression_sink = std::invocable<T&, const unsigned char*, std::size_t>;
+
+	namespace Internal
+	{
+		// The ring buffer is padded to the nearest power-of-two so that the modulos are faster, and so that blocks
+		// are no smaller than 0x1000 bytes (except for the last), even if the dictionary is smaller than that.
+		template<unsigned int dictionary_size>
+		inline constexpr unsigned int sink_ring_size = std::max(std::bit_ceil(dictionary_size), 0x1000u);
+
+		// This is a separate base class so that it is constructed before 'OutputCommonBase' calls 'Reset'.
+		template<typename T, std::size_t buffer_size>
+		class SinkOutputStorage
+		{
+		protected:
+			T sink;
+			std::array<unsigned char, buffer_size> buffer;
+			// Everything from 'flushed_index' to 'index' has yet to be given to the sink.
+			unsigned int index = 0;
+			unsigned int flushed_index = 0;
+			std::size_t position = 0;
+
+			SinkOutputStorage(T sink)
+				: sink(std::forward<T>(sink))
+			{}
+
+			void Flush()
+			{
+				if (index != flushed_index)
+					sink(&buffer[flushed_index], index - flushed_index);
+
+				flushed_index = index;
+			}
+		};
+
+		// The dictionary is a ring buffer, like the one used for streams, and the sink is given the data straight out of it:
+		// a block at a time whenever the ring buffer wraps around, and whatever is left when the output is reset or destroyed.
+		template<typename T, unsigned int dictionary_size, unsigned int maximum_copy_length, int filler_value, typename Derived>
+		class SinkDecompressorOutput : protected SinkOutputStorage<T, sink_ring_size<dictionary_size> + maximum_copy_length - 1>, public OutputCommonBase<Derived>
+		{
+		protected:
+			using Storage = SinkOutputStorage<T, sink_ring_size<dictionary_size> + maximum_copy_length - 1>;
+			using Base = OutputCommonBase<Derived>;
+			using Storage::buffer;
+			using Storage::index;
+			using Storage::flushed_index;
+			using Storage::position;
+
+			static constexpr auto ring_size = sink_ring_size<dictionary_size>;
+
+			const int uncaught_exceptions = std::uncaught_exceptions();
+			bool finished = false;
+
+			// Accounts for 'amount' bytes having been written to the buffer at 'index'.
+			void Advance(const unsigned int amount)
+			{
+				// A lovely little trick that is borrowed from Okumura's LZSS decompressor...
+				if (index < maximum_copy_length - 1)
+					std::copy_n(&buffer[index], std::min(amount, maximum_copy_length - 1 - index), &buffer[ring_size + index]);
+
+				index += amount;
+				position += amount;
+
+				if (index == ring_size)
+				{
+					Storage::Flush();
+					index = flushed_index = 0;
+				}
+			}
+
+			// Passes the dictionary to 'callback' in pieces, for it to write 'size' bytes to.
+			template<typename Callback>
+			void WriteToBuffer(std::size_t size, const Callback &callback)
+			{
+				while (size != 0)
+				{
+					const unsigned int amount = std::min<std::size_t>(size, ring_size - index);
+
+					callback(&buffer[index], amount);
+					Advance(amount);
+					size -= amount;
+				}
+			}
+
+			void WriteImplementation(const unsigned char value)
+			{
+				buffer[index] = value;
+				Advance(1);
+			}
+
+			void WriteBlockImplementation(const unsigned char *data, const std::size_t size)
+			{
+				WriteToBuffer(size, [&](unsigned char* const destination, const std::size_t amount)
+				{
+					std::copy_n(data, amount, destination);
+					data += amount;
+				});
+			}
+
+			void FillImplementation(const unsigned char value, const std::size_t count)
+			{
+				WriteToBuffer(count, [&](unsigned char* const destination, const std::size_t amount)
+				{
+					std::fill_n(destination, amount, value);
+				});
+			}
+
+			template<typename Input>
+			void CopyFromImplementation(Input &input, const std::size_t count)
+			{
+				WriteToBuffer(count, [&](unsigned char* const destination, const std::size_t amount)
+				{
+					input.ReadBlock(destination, amount);
+				});
+			}
+
+			void ResetImplementation()
+			{
+				// The sink has to see the data before the filler value replaces it.
+				Storage::Flush();
+
+				if constexpr(filler_value != -1)
+					buffer.fill(filler_value);
+			}
+
+			void FinishImplementation()
+			{
+				finished = true;
+				Storage::Flush();
+			}
+
+		public:
+			using pos_type = std::size_t;
+			using difference_type = std::ptrdiff_t;
+
+			SinkDecompressorOutput(T sink)
+				: Storage(std::forward<T>(sink))
+			{}
+
+			SinkDecompressorOutput(const SinkDecompressorOutput &other) = delete;
+			SinkDecompressorOutput& operator=(const SinkDecompressorOutput &other) = delete;
+
+			// The sink may throw, but destructors must not, so call 'Finish' to let it.
+			// There is no point in flushing if the output is being abandoned due to an exception.
+			~SinkDecompressorOutput()
+			{
+				if (!finished && std::uncaught_exceptions() == uncaught_exceptions)
+				{
+					try
+					{
+						Storage::Flush();
+					}
+					catch (...)
+					{}
+				}
+			}
+
+			void Copy(const unsigned int distance, const unsigned int count)
+			{
+				const unsigned int source_index = (index - distance + ring_size) % ring_size;
+
+				for (unsigned int i = 0; i < count; ++i)
+					WriteImplementation(buffer[source_index + i]);
+			}
+
+			pos_type Tell() const
+			{
+				return position;
+			}
+
+			difference_type Distance(const pos_type &first) const
+			{
+				return Distance(first, Tell());
+			}
+
+			static difference_type Distance(const pos_type &first, const pos_type &last)
+			{
+				return last - first;
+			}
+
+			friend Base;
+		};
+	}
+
+	// DecompressorOutputBasic
+
+	template<typename T>
+	class DecompressorOutputBasic : public Internal::OutputCommon<T, DecompressorOutputBasic<T>>
+	{
+	public:
+		DecompressorOutputBasic(T output);
+	};
+
+	template<typename T>
+	requires std::random_access_iterator<std::decay_t<T>>
+	class DecompressorOutputBasic<T> : public Internal::OutputCommon<T, DecompressorOutputBasic<T>>
+	{
+	public:
+		using Internal::OutputCommon<T, DecompressorOutputBasic<T>>::OutputCommon;
+	};
+
+	#if __STDC_HOSTED__
+	template<typename T>
+	requires std::is_convertible_v<T&, std::ostream&>
+	class DecompressorOutputBasic<T> : public Internal::OutputCommon<T, DecompressorOutputBasic<T>>
+	{
+	public:
+		using Internal::OutputCommon<T, DecompressorOutputBasic<T>>::OutputCommon;
+	};
+	#endif
+
+	template<typename T>
+	requires std::is_same_v<T, Internal::Discard>
+	class DecompressorOutputBasic<T> : public Internal::DiscardingOutput<DecompressorOutputBasic<T>>
+	{};
+
+	// There is no dictionary here, so the buffer merely gathers the data into blocks.
+	template<typename T>
+	requires decompression_sink<T>
+	class DecompressorOutputBasic<T> : public Internal::SinkDecompressorOutput<T, 0x1000, 1, -1, DecompressorOutputBasic<T>>
+	{
+	public:
+		using Internal::SinkDecompressorOutput<T, 0x1000, 1, -1, DecompressorOutputBasic<T>>::SinkDecompressorOutput;
+	};
+
+	template<typename T>
+	requires Internal::is_bounded<std::decay_t<T>>
+	class DecompressorOutputBasic<T> : public Internal::BoundedOutput<Internal::OutputCommon<decltype(std::decay_t<T>::begin), DecompressorOutputBasic<T>>, DecompressorOutputBasic<T>>
+	{
+	public:
+		using Internal::BoundedOutput<Internal::OutputCommon<decltype(std::decay_t<T>::begin), DecompressorOutputBasic<T>>, DecompressorOutputBasic<T>>::BoundedOutput;
+	};
+
+	namespace Internal
+	{
+		// Random-access outputs serve as their own dictionary.
+		template<typename T, unsigned int dictionary_size, unsigned int maximum_copy_length, int filler_value, typename Derived>
+		class RandomAccessDecompressorOutput : public OutputCommon<T, Derived>
+		{
+		protected:
+			using Base = OutputCommon<T, Derived>;
+			using Iterator = Base::Iterator;
+			using Base::iterator;
+
+			Iterator start_iterator;
+
+			void ResetImplementation()
+			{
+				if constexpr(filler_value != -1)
+					start_iterator = iterator;
+			}
+
+		public:
+			RandomAccessDecompressorOutput(Iterator iterator)
+				: Base(iterator)
+			{
+				// The base class' constructor calls this before the iterator is set, so do it again.
+				ResetImplementation();
+			}
+
+			void Copy(const unsigned int distance, const unsigned int count)
+			{
+				unsigned int copied = 0;
+
+				if constexpr(filler_value != -1)
+				{
+					// Anything before the start of the output is the filler value.
+					const unsigned int limit = Base::Distance(start_iterator);
+
+					if (distance > limit)
+					{
+						copied = std::min(distance - limit, count);
+						Base::Fill(filler_value, copied);
+					}
+				}
+
+				if (distance >= count - copied)
+				{
+					iterator = std::copy(iterator - distance, iterator - distance + (count - copied), iterator);
+				}
+				else
+				{
+					// The source overlaps the destination, so this must be done one byte at a time.
+					for (; copied < count; ++copied)
+					{
+						*iterator = *(iterator - distance);
+						++iterator;
+					}
+				}
+			}
+
+			friend Base::Base;
+		};
+	}
+
+	// DecompressorOutput
+
+	template<typename T, unsigned int dictionary_size, unsigned int maximum_copy_length, int filler_value = -1>
+	class DecompressorOutput : public Internal::OutputCommon<T, DecompressorOutput<T, dictionary_size, maximum_copy_length, filler_value>>
+	{
+	public:
+		DecompressorOutput(T output);
+	};
+
+	template<typename T, unsigned int dictionary_size, unsigned int maximum_copy_length, int filler_value>
+	requires Internal::random_access_input_output_iterator<std::decay_t<T>>
+	class DecompressorOutput<T, dictionary_size, maximum_copy_length, filler_value> : public Internal::RandomAccessDecompressorOutput<T, dictionary_size, maximum_copy_length, filler_value, DecompressorOutput<T, dictionary_size, maximum_copy_length, filler_value>>
+	{
+	public:
+		using Internal::RandomAccessDecompressorOutput<T, dictionary_size, maximum_copy_length, filler_value, DecompressorOutput<T, dictionary_size, maximum_copy_length, filler_value>>::RandomAccessDecompressorOutput;
+	};
+
+	#if __STDC_HOSTED__
+	template<typename T, unsigned int dictionary_size, unsigned int maximum_copy_length, int filler_value>
+	requires std::is_convertible_v<T&, std::ostream&>
+	class DecompressorOutput<T, dictionary_size, maximum_copy_length, filler_value> : public Internal::OutputCommon<T, DecompressorOutput<T, dictionary_size, maximum_copy_length, filler_value>>
+	{
+	protected:
+		using Base = Internal::OutputCommon<T, DecompressorOutput<T, dictionary_size, maximum_copy_length, filler_value>>;
+
+		// Pad this to the nearest power-of-two so that the modulos are faster.
+		static constexpr auto padded_dictionary_size = std::bit_ceil(dictionary_size);
+
+		std::array<unsigned char, padded_dictionary_size + maximum_copy_length - 1> buffer;
+		unsigned int index = 0;
+
+		void WriteToBuffer(const unsigned char value)
+		{
+			buffer[index] = value;
+
+			// A lovely little trick that is borrowed from Okumura's LZSS decompressor...
+			if (index < maximum_copy_length - 1)
+				buffer[padded_dictionary_size + index] = value;
+
+			index = (index + 1) % padded_dictionary_size;
+		}
+
+		// Passes the dictionary to 'callback' in pieces, for it to write 'size' bytes to, and then outputs them.
+		template<typename Callback>
+		void WriteToBuffer(std::size_t size, const Callback &callback)
+		{
+			while (size != 0)
+			{
+				const std::size_t amount = std::min<std::size_t>(size, padded_dictionary_size - index);
+
+				callback(&buffer[index], amount);
+
+				if (index < maximum_copy_length - 1)
+					std::copy_n(&buffer[index], std::min<std::size_t>(amount, maximum_copy_length - 1 - index), &buffer[padded_dictionary_size + index]);
+
+				Base::WriteBlockImplementation(&buffer[index], amount);
+
+				index = (index + amount) % padded_dictionary_size;
+				size -= amount;
+			}
+		}
+
+		void WriteImplementation(const unsigned char value)
+		{
+			WriteToBuffer(value);
+			Base::WriteImplementation(value);
+		}
+
+		void WriteBlockImplementation(const unsigned char *data, const std::size_t size)
+		{
+			WriteToBuffer(size, [&](unsigned char* const destination, const std::size_t amount)
+			{
+				std::copy_n(data, amount, destination);
+				data += amount;
+			});
+		}
+
+		void FillImplementation(const unsigned char value, const std::size_t count)
+		{
+			// Fills are short, so keep this small.
+			for (std::size_t i = 0; i < count; ++i)
+				WriteToBuffer(value);
+
+			Base::FillImplementation(value, count);
+		}
+
+		template<typename Input>
+		void CopyFromImplementation(Input &input, const std::size_t count)
+		{
+			WriteToBuffer(count, [&](unsigned char* const destination, const std::size_t amount)
+			{
+				input.ReadBlock(destination, amount);
+			});
+		}
+
+		void ResetImplementation()
+		{
+			if constexpr(filler_value != -1)
+				buffer.fill(filler_value);
+		}
+
+	public:
+		using Base::Base;
+
+		void Copy(const unsigned int distance, const unsigned int count)
+		{
+			const unsigned int source_index = (index - distance + padded_dictionary_size) % padded_dictionary_size;
+			const unsigned int destination_index = index;
+
+			for (unsigned int i = 0; i < count; ++i)
+				WriteToBuffer(buffer[source_index + i]);
+
+			Base::WriteBlockImplementation(&buffer[destination_index], count);
+		}
+
+		friend Base::Base;
+	};
+	#endif
+
+	template<typename T, unsigned int dictionary_size, unsigned int maximum_copy_length, int filler_value>
+	requires std::is_same_v<T, Internal::Discard>
+	class DecompressorOutput<T, dictionary_size, maximum_copy_length, filler_value> : public Internal::DiscardingOutput<DecompressorOutput<T, dictionary_size, maximum_copy_length, filler_value>>
+	{};
+
+	template<typename T, unsigned int dictionary_size, unsigned int maximum_copy_length, int filler_value>
+	requires decompression_sink<T>
+	class DecompressorOutput<T, dictionary_size, maximum_copy_length, filler_value> : public Internal::SinkDecompressorOutput<T, dictionary_size, maximum_copy_length, filler_value, DecompressorOutput<T, dictionary_size, maximum_copy_length, filler_value>>
+	{
+	public:
+		using Internal::SinkDecompressorOutput<T, dictionary_size, maximum_copy_length, filler_value, DecompressorOutput<T, dictionary_size, maximum_copy_length, filler_value>>::SinkDecompressorOutput;
+	};
+
+	template<typename T, unsigned int dictionary_size, unsigned int maximum_copy_length, int filler_value>
+	requires Internal::is_bounded<std::decay_t<T>>
+	class DecompressorOutput<T, dictionary_size, maximum_copy_length, filler_value> : public Internal::BoundedOutput<Internal::RandomAccessDecompressorOutput<decltype(std::decay_t<T>::begin), dictionary_size, maximum_copy_length, filler_value, DecompressorOutput<T, dictionary_size, maximum_copy_length, filler_value>>, DecompressorOutput<T, dictionary_size, maximum_copy_length, filler_value>>
+	{
+	protected:
+		using Base = Internal::BoundedOutput<Internal::RandomAccessDecompressorOutput<decltype(std::decay_t<T>::begin), dictionary_size, maximum_copy_length, filler_value, DecompressorOutput<T, dictionary_size, maximum_copy_length, filler_value>>, DecompressorOutput<T, dictionary_size, maximum_copy_length, filler_value>>;
+
+	public:
+		using Base::Base;
+
+		void Copy(const unsigned int distance, const unsigned int count)
+		{
+			Base::Require(count);
+
+			// Without a filler value, there is nothing before the start of the output to copy from.
+			if constexpr(filler_value == -1)
+				if (distance > static_cast<std::size_t>(Base::Distance(Base::begin)))
+					throw Internal::OutOfBounds();
+
+			Base::Copy(distance, count);
+		}
+	};
+
+	namespace Internal
+	{
+		// Checking every byte against the end of a bounded input or output costs a lot more than it seems, so decompressors
+		// use these when they know that there is room for the single bytes that they are about to read or write.
+		// Everything else, such as matches and blocks, is passed on to the bounded wrapper, and so is still checked, once each.
+		template<typename Input>
+		class UncheckedInput : public InputCommon<UncheckedInput<Input>>
+		{
+		private:
+			Input &input;
+
+			unsigned char ReadImplementation()
+			{
+				return input.ReadUncheckedImplementation();
+			}
+
+			template<typename OutputIterator>
+			OutputIterator ReadBlockImplementation(const OutputIterator destination, const std::size_t count)
+			{
+				return input.ReadBlock(destination, count);
+			}
+
+		public:
+			UncheckedInput(Input &input)
+				: input(input)
+			{}
+
+			UncheckedInput& operator+=(const unsigned int value)
+			{
+				input += value;
+				return *this;
+			}
+
+			auto Tell() const
+			{
+				return input.Tell();
+			}
+
+			template<typename Position>
+			auto Distance(const Position &first) const
+			{
+				return input.Distance(first);
+			}
+
+			friend InputCommon<UncheckedInput>;
+		};
+
+		template<typename Output>
+		class UncheckedOutput : public OutputCommonBase<UncheckedOutput<Output>>
+		{
+		private:
+			Output &output;
+
+			void WriteImplementation(const unsigned char value)
+			{
+				output.WriteUncheckedImplementation(value);
+			}
+
+			void WriteBlockImplementation(const unsigned char* const data, const std::size_t size)
+			{
+				output.WriteBlock(data, size);
+			}
+
+			void FillImplementation(const unsigned char value, const std::size_t count)
+			{
+				output.Fill(value, count);
+			}
+
+			template<typename Input>
+			void CopyFromImplementation(Input &input, const std::size_t count)
+			{
+				output.CopyFrom(input, count);
+			}
+
+		public:
+			UncheckedOutput(Output &output)
+				: output(output)
+			{}
+
+			void Copy(const unsigned int distance, const unsigned int count)
+			{
+				output.Copy(distance, count);
+			}
+
+			auto Tell() const
+			{
+				return output.Tell();
+			}
+
+			template<typename Position>
+			auto Distance(const Position &first) const
+			{
+				return output.Distance(first);
+			}
+
+			friend OutputCommonBase<UncheckedOutput>;
+		};
+
+		// Calls 'step' to decompress the next literal or match. If 'input' and 'output' are bounded and have room for at least
+		// 'input_bytes' and 'output_bytes' more single bytes, then 'step' is given unchecked versions of them, so only the last
+		// few bytes of the data are checked one at a time. These must be the most that 'step' can use, including any descriptor
+		// field that it may read partway through.
+		template<typename Input, typename Output, typename Step>
+		auto StepWithinBounds(Input &input, Output &output, const std::size_t input_bytes, const std::size_t output_bytes, const Step &step)
+		{
+			constexpr bool input_is_bounded = requires {input.Has(input_bytes);};
+			constexpr bool output_is_bounded = requires {output.Has(output_bytes);};
+
+			if constexpr(input_is_bounded || output_is_bounded)
+			{
+				bool has_room = true;
+
+				if constexpr(input_is_bounded)
+					has_room = has_room && input.Has(input_bytes);
+
+				if constexpr(output_is_bounded)
+					has_room = has_room && output.Has(output_bytes);
+
+				if (has_room) [[likely]]
+				{
+					if constexpr(input_is_bounded && output_is_bounded)
+						return step(UncheckedInput(input), UncheckedOutput(output));
+					else if constexpr(input_is_bounded)
+						return step(UncheckedInput(input), output);
+					else
+						return step(input, UncheckedOutput(output));
+				}
+			}
+
+			return step(input, output);
+		}
+
+		template<unsigned int total_bytes, Endian endian, typename T1, typename T2>
+		void ModuledDecompressionWrapper(DecompressorInput<T1> &input, T2 &output, void (* const decompression_function)(DecompressorInput<T1> &input, T2 &output), const std::size_t module_alignment)
+		{
+			const auto header = input.template Read<total_bytes, endian>();
+
+			const auto input_start_position = input.Tell();
+
+			const unsigned long total_modules = (header + (0x1000 - 1)) / 0x1000; // Round up.
+
+			// Empty data has no modules at all, just the header.
+			if (total_modules == 0)
+				return;
+
+			for (unsigned long i = 0; i < total_modules - 1; ++i)
+			{
+				decompression_function(input, output);
+				input += (module_alignment - (input.Distance(input_start_position) % module_alignment)) % module_alignment;
+				output.Reset();
+			}
+
+			decompression_function(input, output);
+		}
+	}
+
+	#if __STDC_HOSTED__
+	namespace Internal
+	{
+		// Decompresses into a vector that is allocated only once. 'slack' is room for formats whose final match
+		// can run past the size that their header gives; it is trimmed off afterwards.
+		template<typename Function>
+		std::vector<unsigned char> DecompressToVector(const std::size_t size, const std::size_t slack, const Function &decompress)
+		{
+			std::vector<unsigned char> output(size + slack);
+			decompress(output.data());
+			output.resize(size);
+			return output;
+		}
+	}
+
+	// Where each module of moduled data begins, in both the compressed and the decompressed data.
+	// With this, modules can be decompressed out of order, or several at once. Building it requires
+	// going through every module once, so it is worth keeping alongside data that is accessed often.
+	struct ModuleIndex
+	{
+		struct Module
+		{
+			std::size_t compressed_position;
+			std::size_t decompressed_position;
+		};
+
+		std::vector<Module> modules;
+		std::size_t decompressed_size = 0;
+	};
+
+	namespace Internal
+	{
+		// 'output' should be a discarding output, so that the modules are only measured rather than decompressed.
+		template<unsigned int total_bytes, Endian endian, typename T1, typename T2>
+		ModuleIndex BuildModuleIndex(DecompressorInput<T1> &input, T2 &output, void (* const decompression_function)(DecompressorInput<T1> &input, T2 &output), const std::size_t module_alignment)
+		{
+			const auto header_position = input.Tell();
+			const auto header = input.template Read<total_bytes, endian>();
+			const auto input_start_position = input.Tell();
+
+			const unsigned long total_modules = (header + (0x1000 - 1)) / 0x1000; // Round up.
+
+			ModuleIndex index;
+			index.modules.reserve(total_modules);
+
+			for (unsigned long i = 0; i < total_modules; ++i)
+			{
+				if (i != 0)
+					input += (module_alignment - (input.Distance(input_start_position) % module_alignment)) % module_alignment;
+
+				index.modules.push_back({static_cast<std::size_t>(input.Distance(header_position)), output.Tell()});
+				decompression_function(input, output);
+			}
+
+			index.decompressed_size = output.Tell();
+			return index;
+		}
+
+		// Hands each number below 'total' to 'function' once, spread across however many threads call 'Work'.
+		// If any of the calls throw, the remaining ones are abandoned and the first exception is kept for 'Finish'.
+		template<typename Function>
+		class ParallelJob
+		{
+		private:
+			const std::size_t total;
+			const Function &function;
+			std::atomic<std::size_t> next = 0;
+			std::exception_ptr exception;
+			std::mutex exception_mutex;
+
+		public:
+			ParallelJob(const std::size_t total, const Function &function)
+				: total(total)
+				, function(function)
+			{}
+
+			void Work()
+			{
+				try
+				{
+					for (std::size_t i; (i = next++) < total;)
+						function(i);
+				}
+				catch (...)
+				{
+					next = total;
+
+					const std::scoped_lock lock(exception_mutex);
+
+					if (exception == nullptr)
+						exception = std::current_exception();
+				}
+			}
+
+			// Must only be called once every thread has returned from 'Work'.
+			void Finish()
+			{
+				if (exception != nullptr)
+					std::rethrow_exception(exception);
+			}
+		};
+
+		// Calls 'function' once for each number below 'total', using as many threads as the machine has to offer.
+		// If any of the calls throw, the remaining ones are abandoned and the first exception is rethrown.
+		template<typename Function>
+		void RunInParallel(const std::size_t total, const Function &function)
+		{
+			ParallelJob job(total, function);
+
+			const std::size_t total_threads = std::min<std::size_t>(std::thread::hardware_concurrency(), total);
+
+			std::vector<std::thread> threads;
+
+			for (std::size_t i = 1; i < total_threads; ++i)
+				threads.emplace_back([&job](){job.Work();});
+
+			job.Work();
+
+			for (auto &thread : threads)
+				thread.join();
+
+			job.Finish();
+		}
+
+		// Writes bytes 'offset' to 'offset + length' of the decompressed data to 'output', decompressing only the modules
+		// which hold them. 'decompress' is given the position of a module in the compressed data and the range to write it to.
+		// Modules which are wanted in full are decompressed straight into 'output', unless the format needs 'slack'.
+		// Throws OutOfBounds if the range goes past the end of the decompressed data.
+		template<typename T, typename Function>
+		void ModuledDecompressRange(const ModuleIndex &index, const T output, const std::size_t offset, const std::size_t length, const std::size_t slack, const Function &decompress)
+		{
+			if (offset > index.decompressed_size || length > index.decompressed_size - offset)
+				throw OutOfBounds();
+
+			if (length == 0)
+				return;
+
+			const auto &modules = index.modules;
+			const std::size_t end = offset + length;
+
+			const auto first_module = std::upper_bound(modules.begin(), modules.end(), offset, [](const std::size_t position, const ModuleIndex::Module &module){return position < module.decompressed_position;}) - 1;
+			const auto last_module = std::lower_bound(first_module, modules.end(), end, [](const ModuleIndex::Module &module, const std::size_t position){return module.decompressed_position < position;});
+
+			RunInParallel(last_module - first_module, [&](const std::size_t i)
+			{
+				const auto module = first_module + i;
+				const std::size_t module_start = module->decompressed_position;
+				const std::size_t module_end = module + 1 != modules.end() ? module[1].decompressed_position : index.decompressed_size;
+				const std::size_t wanted_start = std::max(module_start, offset);
+				const std::size_t wanted_end = std::min(module_end, end);
+
+				if (slack == 0 && wanted_start == module_start && wanted_end == module_end)
+				{
+					decompress(module->compressed_position, output + (module_start - offset), output + (module_end - offset));
+				}
+				else
+				{
+					std::vector<unsigned char> buffer(module_end - module_start + slack);
+					decompress(module->compressed_position, buffer.data(), buffer.data() + buffer.size());
+					std::copy(buffer.begin() + (wanted_start - module_start), buffer.begin() + (wanted_end - module_start), output + (wanted_start - offset));
+				}
+			});
+		}
+
+		// Hands input from one thread to the decompressor on another. When the decompressor
+		// runs out of input, it waits for more, unless it has been told that there is no more.
+		class IncrementalInputBuffer : public std::streambuf
+		{
+		private:
+			std::mutex mutex;
+			std::condition_variable condition;
+			std::vector<char> pending, current;
+			bool finished = false;
+
+		protected:
+			int_type underflow() override
+			{
+				std::unique_lock lock(mutex);
+				condition.wait(lock, [&](){return !pending.empty() || finished;});
+
+				// The data ended before the decompressor did.
+				if (pending.empty())
+					throw OutOfBounds();
+
+				current.swap(pending);
+				pending.clear();
+				setg(current.data(), current.data(), current.data() + current.size());
+
+				return traits_type::to_int_type(*gptr());
+			}
+
+			// Unlike the default, this does not wait to fill all of 'destination', so the
+			// decompressor can get to work on whatever has been provided so far.
+			std::streamsize xsgetn(char* const destination, const std::streamsize count) override
+			{
+				if (count == 0)
+					return 0;
+
+				if (gptr() == egptr())
+					underflow();
+
+				const std::streamsize amount = std::min<std::streamsize>(count, egptr() - gptr());
+				std::copy_n(gptr(), amount, destination);
+				setg(eback(), gptr() + amount, egptr());
+
+				return amount;
+			}
+
+		public:
+			void Feed(const unsigned char* const data, const std::size_t size)
+			{
+				{
+					const std::scoped_lock lock(mutex);
+					pending.insert(pending.end(), data, data + size);
+				}
+
+				condition.notify_one();
+			}
+
+			void Finish()
+			{
+				{
+					const std::scoped_lock lock(mutex);
+					finished = true;
+				}
+
+				condition.notify_one();
+			}
+		};
+
+		// Collects the decompressor's output until another thread comes to take it.
+		class IncrementalOutput
+		{
+		private:
+			std::mutex mutex;
+			std::vector<unsigned char> output;
+
+		public:
+			void operator()(const unsigned char* const data, const std::size_t size)
+			{
+				const std::scoped_lock lock(mutex);
+				output.insert(output.end(), data, data + size);
+			}
+
+			std::vector<unsigned char> Take()
+			{
+				const std::scoped_lock lock(mutex);
+				return std::exchange(output, {});
+			}
+		};
+	}
+
+	// Decompresses data which arrives a piece at a time, such as from slow storage or a socket, so that
+	// decompression can overlap with waiting for the rest of it. The decompressor runs on a thread of its
+	// own, pausing whenever it reaches the end of the input that it has been fed so far; its dictionary
+	// stays with it in between. Output can be drained whenever it is convenient.
+	// Every one of these starts an operating system thread, and every 'Feed' may wake it, which costs far more than
+	// decompressing small data does; data which is all at hand is better off with the other functions. Output is kept
+	// until it is drained, so the decompressor only ever waits for input; destroying this before 'Finish' stops it there.
+	class IncrementalDecompressor
+	{
+	private:
+		struct State
+		{
+			Internal::IncrementalInputBuffer input;
+			Internal::IncrementalOutput output;
+			std::thread thread;
+			bool success = false;
+			std::exception_ptr exception;
+		};
+
+		std::unique_ptr<State> state;
+
+		void Stop()
+		{
+			state->input.Finish();
+
+			if (state->thread.joinable())
+				state->thread.join();
+		}
+
+	public:
+		// 'decompress' is given an 'std::istream' to decompress from and a sink to decompress to.
+		template<typename Function>
+		IncrementalDecompressor(const Function &decompress)
+			: state(std::make_unique<State>())
+		{
+			state->thread = std::thread([&shared = *state, decompress]()
+			{
+				try
+				{
+					std::istream input(&shared.input);
+					decompress(input, shared.output);
+					shared.success = true;
+				}
+				catch (const Internal::OutOfBounds&)
+				{}
+				catch (...)
+				{
+					shared.exception = std::current_exception();
+				}
+			});
+		}
+
+		IncrementalDecompressor(IncrementalDecompressor &&other) = default;
+		IncrementalDecompressor& operator=(IncrementalDecompressor &&other) = delete;
+
+		~IncrementalDecompressor()
+		{
+			if (state != nullptr)
+				Stop();
+		}
+
+		void Feed(const unsigned char* const data, const std::size_t size)
+		{
+			state->input.Feed(data, size);
+		}
+
+		// Returns whatever has been output since the last time that this was called.
+		std::vector<unsigned char> Drain()
+		{
+			return state->output.Take();
+		}
+
+		// Tells the decompressor that there is no more input, and waits for it to finish.
+		// Returns false if the input ended before the compressed data did.
+		bool Finish()
+		{
+			Stop();
+
+			if (state->exception != nullptr)
+				std::rethrow_exception(std::exchange(state->exception, nullptr));
+
+			return state->success;
+		}
+	};
+
+	namespace Internal
+	{
+		// Thrown into a decompressor whose output is no longer wanted.
+		struct Abandoned {};
+
+		// The decompressor hands its output over a block at a time, waiting until the previous block has been taken.
+		struct DecompressionViewState
+		{
+			std::mutex mutex;
+			std::condition_variable condition;
+			std::vector<unsigned char> pending, current;
+			std::size_t current_index = 0;
+			bool finished = false;
+			bool abandoned = false;
+			std::exception_ptr exception;
+			std::thread thread;
+
+			~DecompressionViewState()
+			{
+				{
+					const std::scoped_lock lock(mutex);
+					abandoned = true;
+				}
+
+				condition.notify_all();
+
+				if (thread.joinable())
+					thread.join();
+			}
+
+			void Give(const unsigned char* const data, const std::size_t size)
+			{
+				std::unique_lock lock(mutex);
+				condition.wait(lock, [&](){return pending.empty() || abandoned;});
+
+				if (abandoned)
+					throw Abandoned();
+
+				pending.assign(data, data + size);
+				condition.notify_all();
+			}
+
+			// Returns false if there is nothing more to take.
+			bool Take()
+			{
+				std::unique_lock lock(mutex);
+				condition.wait(lock, [&](){return !pending.empty() || finished;});
+
+				current.swap(pending);
+				pending.clear();
+				current_index = 0;
+				condition.notify_all();
+
+				if (current.empty() && exception != nullptr)
+					std::rethrow_exception(exception);
+
+				return !current.empty();
+			}
+		};
+
+		class DecompressionViewSink
+		{
+		private:
+			DecompressionViewState &state;
+
+		public:
+			DecompressionViewSink(DecompressionViewState &state)
+				: state(state)
+			{}
+
+			void operator()(const unsigned char* const data, const std::size_t size) const
+			{
+				state.Give(data, size);
+			}
+		};
+	}
+
+	// A range over decompressed data, which is decompressed as it is read. The decompressor runs on a thread of its own,
+	// never getting more than a dictionary's worth of data ahead of the reader; if the reader stops, so does the decompressor.
+	// This makes it cheap to read just the start of some data, such as with 'std::views::take'. Like 'std::ranges::istream_view',
+	// it can only be read from start to finish once.
+	// Every view starts an operating system thread, and the two threads take turns with each block of output, so reading
+	// all of some data this way is slower than decompressing it directly; this is for when only some of it is wanted.
+	// The decompressor only ever waits for the reader, so destroying a view which has not been read to the end stops it there.
+	class DecompressionView : public std::ranges::view_interface<DecompressionView>
+	{
+	private:
+		std::unique_ptr<Internal::DecompressionViewState> state;
+
+	public:
+		class Iterator
+		{
+		private:
+			Internal::DecompressionViewState *state = nullptr;
+
+		public:
+			using value_type = unsigned char;
+			using difference_type = std::ptrdiff_t;
+
+			Iterator() = default;
+
+			Iterator(Internal::DecompressionViewState &state)
+				: state(&state)
+			{}
+
+			unsigned char operator*() const
+			{
+				return state->current[state->current_index];
+			}
+
+			Iterator& operator++()
+			{
+				if (++state->current_index == state->current.size())
+					state->Take();
+
+				return *this;
+			}
+
+			void operator++(int)
+			{
+				++*this;
+			}
+
+			friend bool operator==(const Iterator &iterator, std::default_sentinel_t)
+			{
+				return iterator.state->current_index == iterator.state->current.size();
+			}
+		};
+
+		// 'decompress' is given a sink to decompress to.
+		template<typename Function>
+		DecompressionView(const Function &decompress)
+			: state(std::make_unique<Internal::DecompressionViewState>())
+		{
+			state->thread = std::thread([&shared = *state, decompress]()
+			{
+				try
+				{
+					Internal::DecompressionViewSink sink(shared);
+					decompress(sink);
+				}
+				catch (const Internal::Abandoned&)
+				{}
+				catch (...)
+				{
+					shared.exception = std::current_exception();
+				}
+
+				{
+					const std::scoped_lock lock(shared.mutex);
+					shared.finished = true;
+				}
+
+				shared.condition.notify_all();
+			});
+		}
+
+		Iterator begin()
+		{
+			if (state->current_index == state->current.size())
+				state->Take();
+
+			return Iterator(*state);
+		}
+
+		std::default_sentinel_t end() const
+		{
+			return {};
+		}
+	};
+	#endif
+
+	namespace Internal
+	{
+		// What the wrappers below need to know about a format. Each format derives from this, overriding whatever differs, and adds:
+		// 'Output', the output that its decompressor writes to; 'Decompress', which decompresses one lot of data;
+		// 'module_alignment', which is what each module of moduled data is padded to; and, if the header of the data gives
+		// the size of the decompressed data, 'ReadDecompressedSize', which reads it.
+		struct DecompressorFormat
+		{
+			// Room for formats whose final match can run past the end of the data.
+			static constexpr std::size_t slack = 0;
+			static constexpr unsigned int module_header_size = 2;
+			static constexpr Endian module_header_endian = Endian::Big;
+		};
+
+		// Moduled data is treated as a format of its own, so that it can share the wrappers.
+		template<typename Format>
+		struct ModuledFormat
+		{
+			template<typename T>
+			using Output = typename Format::template Output<T>;
+
+			static constexpr std::size_t slack = Format::slack;
+
+			template<typename T1, typename T2>
+			static void Decompress(DecompressorInput<T1> &input, T2 &output)
+			{
+				ModuledDecompressionWrapper<Format::module_header_size, Format::module_header_endian>(input, output, Format::Decompress, Format::module_alignment);
+			}
+		};
+
+		// The functions which every format provides, built upon its decompressor.
+		template<typename Format>
+		struct DecompressorWrappers
+		{
+			template<typename T1, typename T2>
+			static void Decompress(T1 &&input, T2 &&output)
+			{
+				DecompressorInput input_wrapped(std::forward<T1>(input));
+				typename Format::template Output<T2> output_wrapped(std::forward<T2>(output));
+				Format::Decompress(input_wrapped, output_wrapped);
+				output_wrapped.Finish();
+				input_wrapped.Finish();
+			}
+
+			// Decompresses data that cannot be trusted, returning false if it tries to go outside of either range.
+			template<std::random_access_iterator T1, std::random_access_iterator T2>
+			static bool Decompress(const T1 input, const T1 input_end, const T2 output, const T2 output_end)
+			{
+				return CatchOutOfBounds([&]()
+				{
+					Decompress(Bounded{input, input_end}, Bounded{output, output_end});
+				});
+			}
+
+			// As above, but for sinks, which cannot be overrun, so only the input needs bounds.
+			template<std::random_access_iterator T1, typename T2>
+			requires decompression_sink<T2>
+			static bool Decompress(const T1 input, const T1 input_end, T2 &&output)
+			{
+				return CatchOutOfBounds([&]()
+				{
+					Decompress(Bounded{input, input_end}, std::forward<T2>(output));
+				});
+			}
+
+			template<typename T>
+			static std::size_t DecompressedSize(T &&input)
+			{
+				DecompressorInput input_wrapped(std::forward<T>(input));
+
+				if constexpr (requires {Format::ReadDecompressedSize(input_wrapped);})
+				{
+					const std::size_t size = Format::ReadDecompressedSize(input_wrapped);
+					input_wrapped.Finish();
+					return size;
+				}
+				else
+				{
+					typename Format::template Output<Discard> output_wrapped;
+					Format::Decompress(input_wrapped, output_wrapped);
+					output_wrapped.Finish();
+					input_wrapped.Finish();
+					return output_wrapped.Tell();
+				}
+			}
+
+		#if __STDC_HOSTED__
+			template<std::forward_iterator T>
+			static std::vector<unsigned char> DecompressToVector(const T input)
+			{
+				return Internal::DecompressToVector(DecompressedSize(input), Format::slack, [&](unsigned char* const output)
+				{
+					Decompress(input, output);
+				});
+			}
+
+			static IncrementalDecompressor DecompressIncrementally()
+			{
+				return IncrementalDecompressor([](std::istream &input, auto &output)
+				{
+					Decompress(input, output);
+				});
+			}
+
+			template<std::forward_iterator T>
+			static DecompressionView DecompressLazily(const T input)
+			{
+				return DecompressionView([input](auto &sink)
+				{
+					Decompress(input, sink);
+				});
+			}
+		#endif
+		};
+
+		template<typename Format>
+		struct ModuledDecompressorWrappers : public DecompressorWrappers<ModuledFormat<Format>>
+		{
+		#if __STDC_HOSTED__
+			// Returns nothing if the data tries to go outside of the input.
+			template<std::random_access_iterator T>
+			static std::optional<ModuleIndex> Index(const T input, const T input_end)
+			{
+				std::optional<ModuleIndex> index;
+
+				CatchOutOfBounds([&]()
+				{
+					DecompressorInput input_wrapped(Bounded{input, input_end});
+					typename Format::template Output<Discard> output_wrapped;
+					index = BuildModuleIndex<Format::module_header_size, Format::module_header_endian>(input_wrapped, output_wrapped, Format::Decompress, Format::module_alignment);
+					input_wrapped.Finish();
+				});
+
+				return index;
+			}
+
+			// Returns false if the range goes past the end of the decompressed data, or if the data tries to go outside of
+			// the input or outside of where its modules belong in the output.
+			template<std::random_access_iterator T1, std::random_access_iterator T2>
+			static bool DecompressRange(const T1 input, const T1 input_end, const ModuleIndex &index, const T2 output, const std::size_t offset, const std::size_t length)
+			{
+				return CatchOutOfBounds([&]()
+				{
+					ModuledDecompressRange(index, output, offset, length, Format::slack, [&](const std::size_t position, const auto module_output, const auto module_output_end)
+					{
+						DecompressorWrappers<Format>::Decompress(Bounded{input + position, input_end}, Bounded{module_output, module_output_end});
+					});
+				});
+			}
+
+			template<std::random_access_iterator T1, std::random_access_iterator T2>
+			static bool DecompressParallel(const T1 input, const T1 input_end, const ModuleIndex &index, const T2 output)
+			{
+				return DecompressRange(input, input_end, index, output, 0, index.decompressed_size);
+			}
+		#endif
+		};
+	}
+}
+
+// Rather than each format spelling out the same functions, they are declared here. Each one forwards to 'DecompressorWrappers'.
+#define CLOWNLZSS_DECOMPRESSOR_FORWARD(name, function) \
+	template<typename... Arguments> \
+	auto name(Arguments&&... arguments) -> decltype(function(std::forward<Arguments>(arguments)...)) \
+	{ \
+		return function(std::forward<Arguments>(arguments)...); \
+	}
+
+#if __STDC_HOSTED__
+	#define CLOWNLZSS_DECOMPRESSOR_HOSTED_WRAPPERS(name, format) \
+		CLOWNLZSS_DECOMPRESSOR_FORWARD(name##DecompressToVector, Internal::DecompressorWrappers<format>::DecompressToVector) \
+		CLOWNLZSS_DECOMPRESSOR_FORWARD(name##DecompressIncrementally, Internal::DecompressorWrappers<format>::DecompressIncrementally) \
+		CLOWNLZSS_DECOMPRESSOR_FORWARD(name##DecompressLazily, Internal::DecompressorWrappers<format>::DecompressLazily) \
+		CLOWNLZSS_DECOMPRESSOR_FORWARD(Moduled##name##DecompressToVector, Internal::ModuledDecompressorWrappers<format>::DecompressToVector) \
+		CLOWNLZSS_DECOMPRESSOR_FORWARD(Moduled##name##DecompressIncrementally, Internal::ModuledDecompressorWrappers<format>::DecompressIncrementally) \
+		CLOWNLZSS_DECOMPRESSOR_FORWARD(Moduled##name##DecompressLazily, Internal::ModuledDecompressorWrappers<format>::DecompressLazily) \
+		CLOWNLZSS_DECOMPRESSOR_FORWARD(Moduled##name##Index, Internal::ModuledDecompressorWrappers<format>::Index) \
+		CLOWNLZSS_DECOMPRESSOR_FORWARD(Moduled##name##DecompressRange, Internal::ModuledDecompressorWrappers<format>::DecompressRange) \
+		CLOWNLZSS_DECOMPRESSOR_FORWARD(Moduled##name##DecompressParallel, Internal::ModuledDecompressorWrappers<format>::DecompressParallel)
+#else
+	#define CLOWNLZSS_DECOMPRESSOR_HOSTED_WRAPPERS(name, format)
+#endif
+
+// Declares 'nameDecompress', 'ModulednameDecompress', and the rest, for the format described by 'format'.
+#define CLOWNLZSS_DECOMPRESSOR_WRAPPERS(name, format) \
+	CLOWNLZSS_DECOMPRESSOR_FORWARD(name##Decompress, Internal::DecompressorWrappers<format>::Decompress) \
+	CLOWNLZSS_DECOMPRESSOR_FORWARD(name##DecompressedSize, Internal::DecompressorWrappers<format>::DecompressedSize) \
+	CLOWNLZSS_DECOMPRESSOR_FORWARD(Moduled##name##Decompress, Internal::ModuledDecompressorWrappers<format>::Decompress) \
+	CLOWNLZSS_DECOMPRESSOR_FORWARD(Moduled##name##DecompressedSize, Internal::ModuledDecompressorWrappers<format>::DecompressedSize) \
+	CLOWNLZSS_DECOMPRESSOR_HOSTED_WRAPPERS(name, format)
 
 #endif // CLOWNLZSS_DECOMPRESSORS_COMMON_H
@@ -16,6 +16,7 @@ PERFORMANCE OF THIS SOFTWARE.
 #ifndef CLOWNLZSS_DECOMPRESSORS_COMPER_H
 #define CLOWNLZSS_DECOMPRESSORS_COMPER_H
 
+#include <cstddef>
 #include <utility>
 
 #include "../bitfield.h"
@@ -50,49 +51,53 @@ namespace ClownLZSS
 
 				for (;;)
 				{
-					if (!descriptor_bits.Pop())
+					const bool done = StepWithinBounds(input, output, 4, 2, [&](auto &&input, auto &&output)
 					{
-						// Uncompressed.
-						output.Write(input.Read());
-						output.Write(input.Read());
-					}
-					else
-					{
-						// Dictionary match.
-						const unsigned int raw_distance = input.Read();
-						const unsigned int distance = RawDistanceToDistance(raw_distance);
-						const unsigned int raw_count = input.Read();
-						const unsigned int count = RawCountToCount(raw_count);
-
-						if (raw_count == 0)
-							break;
-
-						output.Copy(distance, count);
-					}
+						if (!descriptor_bits.Pop())
+						{
+							// Uncompressed.
+							output.Write(input.Read());
+							output.Write(input.Read());
+						}
+						else
+						{
+							// Dictionary match.
+							const unsigned int raw_distance = input.Read();
+							const unsigned int distance = RawDistanceToDistance(raw_distance);
+							const unsigned int raw_count = input.Read();
+							const unsigned int count = RawCountToCount(raw_count);
+
+							if (raw_count == 0)
+								return true;
+
+							output.Copy(distance, count);
+						}
+
+						return false;
+					});
+
+					if (done)
+						break;
 				}
 			}
-		}
-	}
-
-	template<typename T1, typename T2>
-	void ComperDecompress(T1 &&input, T2 &&output)
-	{
-		using namespace Internal;
 
-		DecompressorInput input_wrapped(std::forward<T1>(input));
-		Comper::DecompressorOutput<T2> output_wrapped(std::forward<T2>(output));
-		Comper::Decompress(input_wrapped, output_wrapped);
-	}
+			struct Format : public DecompressorFormat
+			{
+				template<typename T>
+				using Output = DecompressorOutput<T>;
 
-	template<typename T1, typename T2>
-	void ModuledComperDecompress(T1 &&input, T2 &&output)
-	{
-		using namespace Internal;
+				static constexpr std::size_t module_alignment = 2;
 
-		DecompressorInput input_wrapped(std::forward<T1>(input));
-		Comper::DecompressorOutput<T2> output_wrapped(std::forward<T2>(output));
-		ModuledDecompressionWrapper<2, Endian::Big>(input_wrapped, output_wrapped, Comper::Decompress, 2);
+				template<typename T1, typename T2>
+				static void Decompress(DecompressorInput<T1> &input, T2 &output)
+				{
+					Comper::Decompress(input, output);
+				}
+			};
+		}
 	}
+
+	CLOWNLZSS_DECOMPRESSOR_WRAPPERS(Comper, Internal::Comper::Format)
 }
 
 #endif // CLOWNLZSS_DECOMPRESSORS_COMPER_H
@@ -16,6 +16,9 @@ PERFORMANCE OF THIS SOFTWARE.
 #ifndef CLOWNLZSS_DECOMPRESSORS_ENIGMA_H
 #define CLOWNLZSS_DECOMPRESSORS_ENIGMA_H
 
+#include <array>
+#include <bit>
+#include <cstddef>
 #include <utility>
 
 #include "../bitfield.h"
@@ -42,26 +45,38 @@ namespace ClownLZSS
 				unsigned int incremental_copy_word = input.ReadBE16();
 				const unsigned int literal_copy_word = input.ReadBE16();
 
-				BitField<decltype(input)> input_bits(input);
+				// The Enigma decompressor in the Sonic games only does 5 bits.
+				const unsigned int total_render_flag_bits = std::popcount(render_flags_mask & 0x1F);
 
-				for (;;)
+				// The render flags which are present are popped all at once, so this spreads them out to where they belong.
+				std::array<unsigned int, 1 << 5> render_flags_table;
+
+				for (unsigned int i = 0; i < 1u << total_render_flag_bits; ++i)
 				{
-					const auto GetInlineValue = [&]()
+					unsigned int render_flags = 0;
+					unsigned int bits_remaining = total_render_flag_bits;
+
+					for (unsigned int j = 0; j < 5; ++j)
 					{
-						unsigned int render_flags = 0;
+						const unsigned int bit_index = 5 - j - 1;
 
-						// The Enigma decompressor in the Sonic games only does 5 bits.
-						for (unsigned int i = 0; i < 5; ++i)
-						{
-							const unsigned int bit_index = 5 - i - 1;
+						if ((render_flags_mask & 1 << bit_index) != 0 && (i & 1 << --bits_remaining) != 0)
+							render_flags |= 1 << bit_index;
+					}
+
+					render_flags_table[i] = render_flags << (3 + 8);
+				}
 
-							render_flags <<= 1;
+				BitField<decltype(input)> input_bits(input);
 
-							if ((render_flags_mask & 1 << bit_index) != 0)
-								render_flags |= input_bits.Pop();
-						}
+				// Each run is gathered here and then written all at once.
+				std::array<unsigned char, 0x10 * 2> words;
 
-						render_flags <<= 3 + 8;
+				for (;;)
+				{
+					const auto GetInlineValue = [&]()
+					{
+						const unsigned int render_flags = render_flags_table[input_bits.Pop(total_render_flag_bits)];
 
 						return render_flags | input_bits.Pop(total_inline_copy_bits);
 					};
@@ -73,12 +88,20 @@ namespace ClownLZSS
 					if (count == 0x10 && action == 5)
 						break;
 
+					unsigned char *word = words.data();
+
+					const auto WriteWord = [&](const unsigned int value)
+					{
+						*word++ = (value >> 8) & 0xFF;
+						*word++ = value & 0xFF;
+					};
+
 					switch (action)
 					{
 						case 0:
 							for (unsigned int i = 0; i < count; ++i)
 							{
-								output.WriteBE16(incremental_copy_word);
+								WriteWord(incremental_copy_word);
 								++incremental_copy_word;
 							}
 
@@ -86,7 +109,7 @@ namespace ClownLZSS
 
 						case 1:
 							for (unsigned int i = 0; i < count; ++i)
-								output.WriteBE16(literal_copy_word);
+								WriteWord(literal_copy_word);
 
 							break;
 
@@ -95,7 +118,7 @@ namespace ClownLZSS
 							const unsigned int inline_value = GetInlineValue();
 
 							for (unsigned int i = 0; i < count; ++i)
-								output.WriteBE16(inline_value);
+								WriteWord(inline_value);
 
 							break;
 						}
@@ -106,7 +129,7 @@ namespace ClownLZSS
 
 							for (unsigned int i = 0; i < count; ++i)
 							{
-								output.WriteBE16(inline_value);
+								WriteWord(inline_value);
 								++inline_value;
 							}
 
@@ -119,7 +142,7 @@ namespace ClownLZSS
 
 							for (unsigned int i = 0; i < count; ++i)
 							{
-								output.WriteBE16(inline_value);
+								WriteWord(inline_value);
 								--inline_value;
 							}
 
@@ -128,34 +151,32 @@ namespace ClownLZSS
 
 						case 5:
 							for (unsigned int i = 0; i < count; ++i)
-								output.WriteBE16(GetInlineValue());
+								WriteWord(GetInlineValue());
 
 							break;
 					}
+
+					output.WriteBlock(words.data(), word - words.data());
 				}
 			}
-		}
-	}
-
-	template<typename T1, typename T2>
-	void EnigmaDecompress(T1 &&input, T2 &&output)
-	{
-		using namespace Internal;
 
-		DecompressorInput input_wrapped(std::forward<T1>(input));
-		Enigma::DecompressorOutput<T2> output_wrapped(std::forward<T2>(output));
-		Enigma::Decompress(input_wrapped, output_wrapped);
-	}
+			struct Format : public DecompressorFormat
+			{
+				template<typename T>
+				using Output = DecompressorOutput<T>;
 
-	template<typename T1, typename T2>
-	void ModuledEnigmaDecompress(T1 &&input, T2 &&output)
-	{
-		using namespace Internal;
+				static constexpr std::size_t module_alignment = 2;
 
-		DecompressorInput input_wrapped(std::forward<T1>(input));
-		Enigma::DecompressorOutput<T2> output_wrapped(std::forward<T2>(output));
-		ModuledDecompressionWrapper<2, Endian::Big>(input_wrapped, output_wrapped, Enigma::Decompress, 2);
+				template<typename T1, typename T2>
+				static void Decompress(DecompressorInput<T1> &input, T2 &output)
+				{
+					Enigma::Decompress(input, output);
+				}
+			};
+		}
 	}
+
+	CLOWNLZSS_DECOMPRESSOR_WRAPPERS(Enigma, Internal::Enigma::Format)
 }
 
 #endif // CLOWNLZSS_DECOMPRESSORS_ENIGMA_H
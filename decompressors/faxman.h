@@ -16,6 +16,7 @@ PERFORMANCE OF THIS SOFTWARE.
 #ifndef CLOWNLZSS_DECOMPRESSORS_FAXMAN_H
 #define CLOWNLZSS_DECOMPRESSORS_FAXMAN_H
 
+#include <cstddef>
 #include <utility>
 
 #include "../bitfield.h"
@@ -50,78 +51,77 @@ namespace ClownLZSS
 
 				while (descriptor_bits_remaining != 0)
 				{
-					if (PopDescriptorBit())
+					StepWithinBounds(input, output, 3, 1, [&](auto &&input, auto &&output)
 					{
-						// Uncompressed.
-						output.Write(input.Read());
-					}
-					else
-					{
-						// Dictionary match.
-						unsigned int distance, count;
-
 						if (PopDescriptorBit())
 						{
-							const unsigned int first_byte = input.Read();
-							const unsigned int second_byte = input.Read();
-
-							distance = (first_byte | ((second_byte << 3) & 0x700)) + 1;
-							count = (second_byte & 0x1F) + 3;
+							// Uncompressed.
+							output.Write(input.Read());
 						}
 						else
 						{
-							distance = 0x100 - input.Read();
-							count = 2;
+							// Dictionary match.
+							unsigned int distance, count;
 
 							if (PopDescriptorBit())
-								count += 2;
-							if (PopDescriptorBit())
-								count += 1;
+							{
+								const unsigned int first_byte = input.Read();
+								const unsigned int second_byte = input.Read();
+
+								distance = (first_byte | ((second_byte << 3) & 0x700)) + 1;
+								count = (second_byte & 0x1F) + 3;
+							}
+							else
+							{
+								distance = 0x100 - input.Read();
+								count = 2;
+
+								if (PopDescriptorBit())
+									count += 2;
+								if (PopDescriptorBit())
+									count += 1;
+							}
+
+							const unsigned int output_position = output.Distance(output_start_position);
+
+							if (distance > output_position)
+							{
+								// Zero-fill.
+								output.Fill(0, count);
+							}
+							else
+							{
+								// Copy.
+								output.Copy(distance, count);
+							}
 						}
+					});
+				}
+			}
 
-						const unsigned int output_position = output.Distance(output_start_position);
+			struct Format : public DecompressorFormat
+			{
+				template<typename T>
+				using Output = DecompressorOutput<T>;
 
-						if (distance > output_position)
-						{
-							// Zero-fill.
-							output.Fill(0, count);
-						}
-						else
-						{
-							// Copy.
-							output.Copy(distance, count);
-						}
-					}
+				static constexpr std::size_t module_alignment = 2;
+
+				template<typename T1, typename T2>
+				static void Decompress(DecompressorInput<T1> &input, T2 &output)
+				{
+					Faxman::Decompress(input, output);
 				}
-			}
+			};
 		}
 	}
 
-	template<typename T1, typename T2>
-	void FaxmanDecompress(T1 &&input, T2 &&output)
-	{
-		using namespace Internal;
-
-		DecompressorInput input_wrapped(std::forward<T1>(input));
-		Faxman::DecompressorOutput<T2> output_wrapped(std::forward<T2>(output));
-		Faxman::Decompress(input_wrapped, output_wrapped);
-	}
+	CLOWNLZSS_DECOMPRESSOR_WRAPPERS(Faxman, Internal::Faxman::Format)
 
 	template<std::random_access_iterator T1, std::random_access_iterator T2>
 	void FaxmanDecompress(T1 input, T1 input_end, T2 output)
 	{
 		FaxmanDecompress(input, output, input_end - input);
 	}
-
-	template<typename T1, typename T2>
-	void ModuledFaxmanDecompress(T1 &&input, T2 &&output)
-	{
-		using namespace Internal;
-
-		DecompressorInput input_wrapped(std::forward<T1>(input));
-		Faxman::DecompressorOutput<T2> output_wrapped(std::forward<T2>(output));
-		ModuledDecompressionWrapper<2, Endian::Big>(input_wrapped, output_wrapped, Faxman::Decompress, 2);
-	}
 }
 
 #endif // CLOWNLZSS_DECOMPRESSORS_FAXMAN_H
@@ -16,6 +16,8 @@ PERFORMANCE OF THIS SOFTWARE.
 #ifndef CLOWNLZSS_DECOMPRESSORS_GBA_H
 #define CLOWNLZSS_DECOMPRESSORS_GBA_H
 
+#include <cstddef>
+
 #include "../bitfield.h"
 #include "common.h"
 
@@ -50,20 +52,23 @@ namespace ClownLZSS
 
 				while (output.Distance(output_start_position) < uncompressed_size)
 				{
-					if (!descriptor_bits.Pop())
-					{
-						// Literal
-						output.Write(input.Read());
-					}
-					else
+					StepWithinBounds(input, output, 3, 1, [&](auto &&input, auto &&output)
 					{
-						// Match
-						const unsigned int b0 = input.Read();
-						const unsigned int b1 = input.Read();
-						const unsigned int count = ((b0 >> 4) & 0xf) + Decompressor::minimum_match_length;
-						const unsigned int distance = (((b0 & 0xfu) << 8) | b1) + Decompressor::minimum_match_distance;
-						output.Copy(distance, count);
-					}
+						if (!descriptor_bits.Pop())
+						{
+							// Literal
+							output.Write(input.Read());
+						}
+						else
+						{
+							// Match
+							const unsigned int b0 = input.Read();
+							const unsigned int b1 = input.Read();
+							const unsigned int count = ((b0 >> 4) & 0xf) + Decompressor::minimum_match_length;
+							const unsigned int distance = (((b0 & 0xfu) << 8) | b1) + Decompressor::minimum_match_distance;
+							output.Copy(distance, count);
+						}
+					});
 				}
 			}
 
@@ -80,28 +85,33 @@ namespace ClownLZSS
 				unsigned int uncompressed_size = ReadHeader(input);
 				Decompress(input, output, uncompressed_size);
 			}
-		}
-	}
 
-	template<typename T1, typename T2>
-	void GbaDecompress(T1 &&input, T2 &&output)
-	{
-		using namespace Internal;
+			struct Format : public DecompressorFormat
+			{
+				template<typename T>
+				using Output = DecompressorOutput<T>;
 
-		DecompressorInput input_wrapped(std::forward<T1>(input));
-		Gba::DecompressorOutput<T2> output_wrapped(std::forward<T2>(output));
-		Gba::Decompress(input_wrapped, output_wrapped);
-	}
+				static constexpr std::size_t slack = Decompressor::maximum_match_length - 1;
+				static constexpr unsigned int module_header_size = Decompressor::module_header_size;
+				static constexpr Endian module_header_endian = Endian::Little;
+				static constexpr std::size_t module_alignment = Decompressor::module_alignment;
 
-	template<typename T1, typename T2>
-	void ModuledGbaDecompress(T1 &&input, T2 &&output)
-	{
-		using namespace Internal;
+				template<typename T>
+				static std::size_t ReadDecompressedSize(DecompressorInput<T> &input)
+				{
+					return ReadHeader(input);
+				}
 
-		DecompressorInput input_wrapped(std::forward<T1>(input));
-		Gba::DecompressorOutput<T2> output_wrapped(std::forward<T2>(output));
-		ModuledDecompressionWrapper<Gba::Decompressor::module_header_size, Endian::Little>(input_wrapped, output_wrapped, Gba::Decompress, Gba::Decompressor::module_alignment);
+				template<typename T1, typename T2>
+				static void Decompress(DecompressorInput<T1> &input, T2 &output)
+				{
+					Gba::Decompress(input, output);
+				}
+			};
+		}
 	}
+
+	CLOWNLZSS_DECOMPRESSOR_WRAPPERS(Gba, Internal::Gba::Format)
 }
 
 #endif
@@ -16,6 +16,7 @@ PERFORMANCE OF THIS SOFTWARE.
 #ifndef CLOWNLZSS_DECOMPRESSORS_KOSINSKI_H
 #define CLOWNLZSS_DECOMPRESSORS_KOSINSKI_H
 
+#include <cstddef>
 #include <utility>
 
 #include "../bitfield.h"
@@ -40,76 +41,80 @@ namespace ClownLZSS
 
 				for (;;)
 				{
-					if (descriptor_bits.Pop())
+					const bool done = StepWithinBounds(input, output, 5, 1, [&](auto &&input, auto &&output)
 					{
-						output.Write(input.Read());
-					}
-					else
-					{
-						unsigned int offset;
-						unsigned int count;
-
 						if (descriptor_bits.Pop())
 						{
-							const unsigned int low_byte = input.Read();
-							const unsigned int high_byte = input.Read();
-
-							offset = ((high_byte & 0xF8) << 5) | low_byte;
-							offset = 0x2000 - offset;
-							count = high_byte & 7;
+							output.Write(input.Read());
+						}
+						else
+						{
+							unsigned int offset;
+							unsigned int count;
 
-							if (count != 0)
+							if (descriptor_bits.Pop())
 							{
-								count += 2;
+								const unsigned int low_byte = input.Read();
+								const unsigned int high_byte = input.Read();
+
+								offset = ((high_byte & 0xF8) << 5) | low_byte;
+								offset = 0x2000 - offset;
+								count = high_byte & 7;
+
+								if (count != 0)
+								{
+									count += 2;
+								}
+								else
+								{
+									count = input.Read() + 1;
+
+									if (count == 1)
+										return true;
+									else if (count == 2)
+										return false;
+								}
 							}
 							else
 							{
-								count = input.Read() + 1;
+								count = 2;
 
-								if (count == 1)
-									break;
-								else if (count == 2)
-									continue;
-							}
-						}
-						else
-						{
-							count = 2;
+								if (descriptor_bits.Pop())
+									count += 2;
+								if (descriptor_bits.Pop())
+									count += 1;
 
-							if (descriptor_bits.Pop())
-								count += 2;
-							if (descriptor_bits.Pop())
-								count += 1;
+								offset = 0x100 - input.Read();
+							}
 
-							offset = 0x100 - input.Read();
+							output.Copy(offset, count);
 						}
 
-						output.Copy(offset, count);
-					}
+						return false;
+					});
+
+					if (done)
+						break;
 				}
 			}
-		}
-	}
 
-	template<typename T1, typename T2>
-	void KosinskiDecompress(T1 &&input, T2 &&output)
-	{
-		using namespace Internal;
-
-		DecompressorInput input_wrapped(std::forward<T1>(input));
-		Kosinski::DecompressorOutput<T2> output_wrapped(std::forward<T2>(output));
-		Kosinski::Decompress(input_wrapped, output_wrapped);
-	}
+			struct Format : public DecompressorFormat
+			{
+				template<typename T>
+				using Output = DecompressorOutput<T>;
 
-	template<typename T1, typename T2>
-	void ModuledKosinskiDecompress(T1 &&input, T2 &&output)
-	{
-		using namespace Internal;
+				static constexpr std::size_t module_alignment = 0x10;
 
-		DecompressorInput input_wrapped(std::forward<T1>(input));
-		Kosinski::DecompressorOutput<T2> output_wrapped(std::forward<T2>(output));
-		ModuledDecompressionWrapper<2, Endian::Big>(input_wrapped, output_wrapped, Kosinski::Decompress, 0x10);
+				template<typename T1, typename T2>
+				static void Decompress(DecompressorInput<T1> &input, T2 &output)
+				{
+					Kosinski::Decompress(input, output);
+				}
+			};
+		}
 	}
+
+	CLOWNLZSS_DECOMPRESSOR_WRAPPERS(Kosinski, Internal::Kosinski::Format)
 }
 
 #endif // CLOWNLZSS_DECOMPRESSORS_KOSINSKI_H
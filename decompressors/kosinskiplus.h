@@ -16,6 +16,7 @@ PERFORMANCE OF THIS SOFTWARE.
 #ifndef CLOWNLZSS_DECOMPRESSORS_KOSINSKIPLUS_H
 #define CLOWNLZSS_DECOMPRESSORS_KOSINSKIPLUS_H
 
+#include <cstddef>
 #include <utility>
 
 #include "../bitfield.h"
@@ -40,74 +41,78 @@ namespace ClownLZSS
 
 				for (;;)
 				{
-					if (descriptor_bits.Pop())
+					const bool done = StepWithinBounds(input, output, 4, 1, [&](auto &&input, auto &&output)
 					{
-						output.Write(input.Read());
-					}
-					else
-					{
-						unsigned int offset;
-						unsigned int count;
-
 						if (descriptor_bits.Pop())
 						{
-							const unsigned int high_byte = input.Read();
-							const unsigned int low_byte = input.Read();
-
-							offset = ((high_byte & 0xF8) << 5) | low_byte;
-							offset = 0x2000 - offset;
-							count = high_byte & 7;
+							output.Write(input.Read());
+						}
+						else
+						{
+							unsigned int offset;
+							unsigned int count;
 
-							if (count != 0)
+							if (descriptor_bits.Pop())
 							{
-								count = 10 - count;
+								const unsigned int high_byte = input.Read();
+								const unsigned int low_byte = input.Read();
+
+								offset = ((high_byte & 0xF8) << 5) | low_byte;
+								offset = 0x2000 - offset;
+								count = high_byte & 7;
+
+								if (count != 0)
+								{
+									count = 10 - count;
+								}
+								else
+								{
+									count = input.Read() + 9;
+
+									if (count == 9)
+										return true;
+								}
 							}
 							else
 							{
-								count = input.Read() + 9;
+								offset = 0x100 - input.Read();
 
-								if (count == 9)
-									break;
-							}
-						}
-						else
-						{
-							offset = 0x100 - input.Read();
+								count = 2;
 
-							count = 2;
+								if (descriptor_bits.Pop())
+									count += 2;
+								if (descriptor_bits.Pop())
+									count += 1;
+							}
 
-							if (descriptor_bits.Pop())
-								count += 2;
-							if (descriptor_bits.Pop())
-								count += 1;
+							output.Copy(offset, count);
 						}
 
-						output.Copy(offset, count);
-					}
+						return false;
+					});
+
+					if (done)
+						break;
 				}
 			}
-		}
-	}
 
-	template<typename T1, typename T2>
-	void KosinskiPlusDecompress(T1 &&input, T2 &&output)
-	{
-		using namespace Internal;
-
-		DecompressorInput input_wrapped(std::forward<T1>(input));
-		KosinskiPlus::DecompressorOutput<T2> output_wrapped(std::forward<T2>(output));
-		KosinskiPlus::Decompress(input_wrapped, output_wrapped);
-	}
+			struct Format : public DecompressorFormat
+			{
+				template<typename T>
+				using Output = DecompressorOutput<T>;
 
-	template<typename T1, typename T2>
-	void ModuledKosinskiPlusDecompress(T1 &&input, T2 &&output)
-	{
-		using namespace Internal;
+				static constexpr std::size_t module_alignment = 1;
 
-		DecompressorInput input_wrapped(std::forward<T1>(input));
-		KosinskiPlus::DecompressorOutput<T2> output_wrapped(std::forward<T2>(output));
-		ModuledDecompressionWrapper<2, Endian::Big>(input_wrapped, output_wrapped, KosinskiPlus::Decompress, 1);
+				template<typename T1, typename T2>
+				static void Decompress(DecompressorInput<T1> &input, T2 &output)
+				{
+					KosinskiPlus::Decompress(input, output);
+				}
+			};
+		}
 	}
+
+	CLOWNLZSS_DECOMPRESSOR_WRAPPERS(KosinskiPlus, Internal::KosinskiPlus::Format)
 }
 
 #endif // CLOWNLZSS_DECOMPRESSORS_KOSINSKI_H
@@ -16,6 +16,7 @@ PERFORMANCE OF THIS SOFTWARE.
 #ifndef CLOWNLZSS_DECOMPRESSORS_RAGE_H
 #define CLOWNLZSS_DECOMPRESSORS_RAGE_H
 
+#include <cstddef>
 #include <utility>
 
 #include "common.h"
@@ -40,87 +41,84 @@ namespace ClownLZSS
 
 				while (input.Distance(input_start_position) < compressed_size)
 				{
-					const unsigned int first_byte = input.Read();
-
-					switch (first_byte >> 5)
+					StepWithinBounds(input, output, 3, 0, [&](auto &&input, auto &&output)
 					{
-						case 0:
-						case 1:
-						{
-							unsigned int count;
-
-							if ((first_byte & 0x20) != 0)
-								count = ((first_byte << 8) & 0x1F00) | input.Read();
-							else
-								count = first_byte;
-
-							// TODO: There should be a helper function for this, so that it can be optimised for file IO.
-							for (unsigned int i = 0; i < count; ++i)
-								output.Write(input.Read());
+						const unsigned int first_byte = input.Read();
 
-							break;
-						}
-
-						case 2:
+						switch (first_byte >> 5)
 						{
-							unsigned int count = 4;
-
-							if ((first_byte & 0x10) != 0)
-								count += ((first_byte << 8) & 0xF00) | input.Read();
-							else
-								count += first_byte & 0xF;
-
-							const unsigned char value = input.Read();
-
-							output.Fill(value, count);
-							break;
+							case 0:
+							case 1:
+							{
+								unsigned int count;
+
+								if ((first_byte & 0x20) != 0)
+									count = ((first_byte << 8) & 0x1F00) | input.Read();
+								else
+									count = first_byte;
+
+								output.CopyFrom(input, count);
+
+								break;
+							}
+
+							case 2:
+							{
+								unsigned int count = 4;
+
+								if ((first_byte & 0x10) != 0)
+									count += ((first_byte << 8) & 0xF00) | input.Read();
+								else
+									count += first_byte & 0xF;
+
+								const unsigned char value = input.Read();
+
+								output.Fill(value, count);
+								break;
+							}
+
+							case 3:
+							{
+								const unsigned int count = first_byte & 0x1F;
+
+								output.Copy(distance, count);
+								break;
+							}
+
+							case 4:
+							case 5:
+							case 6:
+							case 7:
+							{
+								const unsigned int second_byte = input.Read();
+								const unsigned int count = ((first_byte >> 5) & 3) + 4;
+
+								distance = ((first_byte << 8) & 0x1F00) | second_byte;
+								output.Copy(distance, count);
+								break;
+							}
 						}
+					});
+				}
+			}
 
-						case 3:
-						{
-							const unsigned int count = first_byte & 0x1F;
-
-							output.Copy(distance, count);
-							break;
-						}
+			struct Format : public DecompressorFormat
+			{
+				template<typename T>
+				using Output = DecompressorOutput<T>;
 
-						case 4:
-						case 5:
-						case 6:
-						case 7:
-						{
-							const unsigned int second_byte = input.Read();
-							const unsigned int count = ((first_byte >> 5) & 3) + 4;
+				static constexpr std::size_t module_alignment = 2;
 
-							distance = ((first_byte << 8) & 0x1F00) | second_byte;
-							output.Copy(distance, count);
-							break;
-						}
-					}
+				template<typename T1, typename T2>
+				static void Decompress(DecompressorInput<T1> &input, T2 &output)
+				{
+					Rage::Decompress(input, output);
 				}
-			}
+			};
 		}
 	}
 
-	template<typename T1, typename T2>
-	void RageDecompress(T1 &&input, T2 &&output)
-	{
-		using namespace Internal;
-
-		DecompressorInput input_wrapped(std::forward<T1>(input));
-		Rage::DecompressorOutput<T2> output_wrapped(std::forward<T2>(output));
-		Rage::Decompress(input_wrapped, output_wrapped);
-	}
-
-	template<typename T1, typename T2>
-	void ModuledRageDecompress(T1 &&input, T2 &&output)
-	{
-		using namespace Internal;
-
-		DecompressorInput input_wrapped(std::forward<T1>(input));
-		Rage::DecompressorOutput<T2> output_wrapped(std::forward<T2>(output));
-		ModuledDecompressionWrapper<2, Endian::Big>(input_wrapped, output_wrapped, Rage::Decompress, 2);
-	}
+	CLOWNLZSS_DECOMPRESSOR_WRAPPERS(Rage, Internal::Rage::Format)
 }
 
 #endif // CLOWNLZSS_DECOMPRESSORS_RAGE_H
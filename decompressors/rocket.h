@@ -16,6 +16,7 @@ PERFORMANCE OF THIS SOFTWARE.
 #ifndef CLOWNLZSS_DECOMPRESSORS_ROCKET_H
 #define CLOWNLZSS_DECOMPRESSORS_ROCKET_H
 
+#include <cstddef>
 #include <utility>
 
 #include "../bitfield.h"
@@ -51,45 +52,52 @@ namespace ClownLZSS
 					if (output_position >= uncompressed_size)
 						break;
 
-					if (descriptor_bits.Pop())
+					StepWithinBounds(input, output, 3, 1, [&](auto &&input, auto &&output)
 					{
-						// Uncompressed.
-						output.Write(input.Read());
-					}
-					else
-					{
-						// Dictionary match.
-						const unsigned int word = input.ReadBE16();
-						const unsigned int dictionary_index = (word + 0x40) % 0x400;
-						const unsigned int count = (word >> 10) + 1;
-						const unsigned int distance = ((0x400 + output_position - dictionary_index - 1) % 0x400) + 1;
-
-						output.Copy(distance, count);
-					}
+						if (descriptor_bits.Pop())
+						{
+							// Uncompressed.
+							output.Write(input.Read());
+						}
+						else
+						{
+							// Dictionary match.
+							const unsigned int word = input.ReadBE16();
+							const unsigned int dictionary_index = (word + 0x40) % 0x400;
+							const unsigned int count = (word >> 10) + 1;
+							const unsigned int distance = ((0x400 + output_position - dictionary_index - 1) % 0x400) + 1;
+
+							output.Copy(distance, count);
+						}
+					});
 				}
 			}
-		}
-	}
 
-	template<typename T1, typename T2>
-	void RocketDecompress(T1 &&input, T2 &&output)
-	{
-		using namespace Internal;
+			struct Format : public DecompressorFormat
+			{
+				template<typename T>
+				using Output = DecompressorOutput<T>;
 
-		DecompressorInput input_wrapped(std::forward<T1>(input));
-		Rocket::DecompressorOutput<T2> output_wrapped(std::forward<T2>(output));
-		Rocket::Decompress(input_wrapped, output_wrapped);
-	}
+				// The final match can run up to a match's length past the end of the data.
+				static constexpr std::size_t slack = 0x40 - 1;
+				static constexpr std::size_t module_alignment = 2;
 
-	template<typename T1, typename T2>
-	void ModuledRocketDecompress(T1 &&input, T2 &&output)
-	{
-		using namespace Internal;
+				template<typename T>
+				static std::size_t ReadDecompressedSize(DecompressorInput<T> &input)
+				{
+					return input.ReadBE16();
+				}
 
-		DecompressorInput input_wrapped(std::forward<T1>(input));
-		Rocket::DecompressorOutput<T2> output_wrapped(std::forward<T2>(output));
-		ModuledDecompressionWrapper<2, Endian::Big>(input_wrapped, output_wrapped, Rocket::Decompress, 2);
+				template<typename T1, typename T2>
+				static void Decompress(DecompressorInput<T1> &input, T2 &output)
+				{
+					Rocket::Decompress(input, output);
+				}
+			};
+		}
 	}
+
+	CLOWNLZSS_DECOMPRESSOR_WRAPPERS(Rocket, Internal::Rocket::Format)
 }
 
 #endif // CLOWNLZSS_DECOMPRESSORS_ROCKET_H
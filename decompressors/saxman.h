@@ -16,7 +16,12 @@ PERFORMANCE OF THIS SOFTWARE.
 #ifndef CLOWNLZSS_DECOMPRESSORS_SAXMAN_H
 #define CLOWNLZSS_DECOMPRESSORS_SAXMAN_H
 
+#include <cstddef>
+#include <iterator>
 #include <utility>
+#if __STDC_HOSTED__
+	#include <vector>
+#endif
 
 #include "../bitfield.h"
 #include "common.h"
@@ -43,32 +48,35 @@ namespace ClownLZSS
 
 				while (input.Distance(input_start_position) < compressed_length)
 				{
-					if (descriptor_bits.Pop())
+					StepWithinBounds(input, output, 3, 1, [&](auto &&input, auto &&output)
 					{
-						// Uncompressed.
-						output.Write(input.Read());
-					}
-					else
-					{
-						// Dictionary match.
-						const unsigned int first_byte = input.Read();
-						const unsigned int second_byte = input.Read();
-						const unsigned int dictionary_index = (first_byte | ((second_byte << 4) & 0xF00)) + (0xF + 3);
-						const unsigned int count = (second_byte & 0xF) + 3;
-						const unsigned int output_position = output.Distance(output_start_position);
-						const unsigned int distance = (output_position - dictionary_index) % 0x1000;
-
-						if (distance > output_position)
+						if (descriptor_bits.Pop())
 						{
-							// Zero-fill.
-							output.Fill(0, count);
+							// Uncompressed.
+							output.Write(input.Read());
 						}
 						else
 						{
-							// Copy.
-							output.Copy(distance, count);
+							// Dictionary match.
+							const unsigned int first_byte = input.Read();
+							const unsigned int second_byte = input.Read();
+							const unsigned int dictionary_index = (first_byte | ((second_byte << 4) & 0xF00)) + (0xF + 3);
+							const unsigned int count = (second_byte & 0xF) + 3;
+							const unsigned int output_position = output.Distance(output_start_position);
+							const unsigned int distance = (output_position - dictionary_index) % 0x1000;
+
+							if (distance > output_position)
+							{
+								// Zero-fill.
+								output.Fill(0, count);
+							}
+							else
+							{
+								// Copy.
+								output.Copy(distance, count);
+							}
 						}
-					}
+					});
 				}
 			}
 
@@ -79,9 +87,25 @@ namespace ClownLZSS
 
 				Decompress(input, output, compressed_length);
 			}
+
+			struct Format : public DecompressorFormat
+			{
+				template<typename T>
+				using Output = DecompressorOutput<T>;
+
+				static constexpr std::size_t module_alignment = 2;
+
+				template<typename T1, typename T2>
+				static void Decompress(DecompressorInput<T1> &input, T2 &output)
+				{
+					Saxman::Decompress(input, output);
+				}
+			};
 		}
 	}
 
+	CLOWNLZSS_DECOMPRESSOR_WRAPPERS(Saxman, Internal::Saxman::Format)
+
 	template<typename T1, typename T2>
 	void SaxmanDecompress(T1 &&input, T2 &&output, const unsigned int compressed_length)
 	{
@@ -90,16 +114,31 @@ namespace ClownLZSS
 		DecompressorInput input_wrapped(std::forward<T1>(input));
 		Saxman::DecompressorOutput<T2> output_wrapped(std::forward<T2>(output));
 		Saxman::Decompress(input_wrapped, output_wrapped, compressed_length);
+		output_wrapped.Finish();
+		input_wrapped.Finish();
 	}
 
-	template<typename T1, typename T2>
-	void SaxmanDecompress(T1 &&input, T2 &&output)
+	template<std::random_access_iterator T1, std::random_access_iterator T2>
+	bool SaxmanDecompress(const T1 input, const T1 input_end, const T2 output, const T2 output_end, const unsigned int compressed_length)
 	{
 		using namespace Internal;
 
-		DecompressorInput input_wrapped(std::forward<T1>(input));
-		Saxman::DecompressorOutput<T2> output_wrapped(std::forward<T2>(output));
-		Saxman::Decompress(input_wrapped, output_wrapped);
+		return CatchOutOfBounds([&]()
+		{
+			SaxmanDecompress(Bounded{input, input_end}, Bounded{output, output_end}, compressed_length);
+		});
+	}
+
+	template<std::random_access_iterator T1, typename T2>
+	requires decompression_sink<T2>
+	bool SaxmanDecompress(const T1 input, const T1 input_end, T2 &&output, const unsigned int compressed_length)
+	{
+		using namespace Internal;
+
+		return CatchOutOfBounds([&]()
+		{
+			SaxmanDecompress(Bounded{input, input_end}, std::forward<T2>(output), compressed_length);
+		});
 	}
 
 	template<std::random_access_iterator T1, std::random_access_iterator T2>
@@ -108,15 +147,46 @@ namespace ClownLZSS
 		SaxmanDecompress(input, output, std::distance(input, input_end));
 	}
 
-	template<typename T1, typename T2>
-	void ModuledSaxmanDecompress(T1 &&input, T2 &&output)
+	template<typename T>
+	std::size_t SaxmanDecompressedSize(T &&input, const unsigned int compressed_length)
 	{
 		using namespace Internal;
 
-		DecompressorInput input_wrapped(std::forward<T1>(input));
-		Saxman::DecompressorOutput<T2> output_wrapped(std::forward<T2>(output));
-		ModuledDecompressionWrapper<2, Endian::Big>(input_wrapped, output_wrapped, Saxman::Decompress, 2);
+		DecompressorInput input_wrapped(std::forward<T>(input));
+		Saxman::DecompressorOutput<Discard> output_wrapped;
+		Saxman::Decompress(input_wrapped, output_wrapped, compressed_length);
+		output_wrapped.Finish();
+		input_wrapped.Finish();
+		return output_wrapped.Tell();
+	}
+
+	#if __STDC_HOSTED__
+	template<std::forward_iterator T>
+	std::vector<unsigned char> SaxmanDecompressToVector(const T input, const unsigned int compressed_length)
+	{
+		return Internal::DecompressToVector(SaxmanDecompressedSize(input, compressed_length), 0, [&](unsigned char* const output)
+		{
+			SaxmanDecompress(input, output, compressed_length);
+		});
+	}
+
+	inline IncrementalDecompressor SaxmanDecompressIncrementally(const unsigned int compressed_length)
+	{
+		return IncrementalDecompressor([compressed_length](std::istream &input, auto &output)
+		{
+			SaxmanDecompress(input, output, compressed_length);
+		});
+	}
+
+	template<std::forward_iterator T>
+	DecompressionView SaxmanDecompressLazily(const T input, const unsigned int compressed_length)
+	{
+		return DecompressionView([input, compressed_length](auto &sink)
+		{
+			SaxmanDecompress(input, sink, compressed_length);
+		});
 	}
+	#endif
 }
 
 #endif // CLOWNLZSS_DECOMPRESSORS_SAXMAN_H
@@ -13,15 +13,35 @@ OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
 PERFORMANCE OF THIS SOFTWARE.
 */
 
+#include <algorithm>
 #include <array>
 #include <cstdlib>
 #include <filesystem>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <limits>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <streambuf>
 #include <string>
 #include <string_view>
 #include <vector>
 
+#ifdef _WIN32
+	#include <fcntl.h>
+	#include <io.h>
+#endif
+
+#if defined(__unix__) || (defined(__APPLE__) && defined(__MACH__))
+	#define CLOWNLZSS_MMAP
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
 #include "compressors/chameleon.h"
 #include "compressors/comper.h"
 #include "compressors/enigma.h"
@@ -66,21 +86,25 @@ struct Mode
 	Format format;
 	std::string normal_default_filename;
 	std::string moduled_default_filename;
+	// Formats with one of these can share a single search for matches when they are compared.
+	const ClownLZSS::MatchSearch *match_search;
+	// Formats with one of these can be ruled out without compressing the data, when it is large.
+	bool (*estimate_compressed_size)(const unsigned char *data, std::size_t data_size, ClownLZSS::CompressedSizeEstimate &estimate);
 };
 
 static const auto modes = std::to_array<Mode>({
-	{"-ch", Format::CHAMELEON,        "out.cham", "out.chamm"},
-	{"-c",  Format::COMPER,           "out.comp", "out.compm"},
-	{"-e",  Format::ENIGMA,           "out.eni",  "out.enim" },
-	{"-f",  Format::FAXMAN,           "out.fax",  "out.faxm" },
-	{"-g",  Format::GBA,              "out.gba",  "out.gbam" },
-	{"-gv", Format::GBA_VRAM_SAFE,    "out.gba",  "out.gbam" },
-	{"-k",  Format::KOSINSKI,         "out.kos",  "out.kosm" },
-	{"-kp", Format::KOSINSKIPLUS,     "out.kosp", "out.kospm"},
-	{"-ra", Format::RAGE,             "out.rage", "out.ragem"},
-	{"-r",  Format::ROCKET,           "out.rock", "out.rockm"},
-	{"-s",  Format::SAXMAN,           "out.sax",  "out.saxm" },
-	{"-sn", Format::SAXMAN_NO_HEADER, "out.sax",  "out.saxm" }
+	{"-ch", Format::CHAMELEON,        "out.cham", "out.chamm", &ClownLZSS::chameleon_match_search,     ClownLZSS::ChameleonEstimateCompressedSize          },
+	{"-c",  Format::COMPER,           "out.comp", "out.compm", nullptr,                                ClownLZSS::ComperEstimateCompressedSize             },
+	{"-e",  Format::ENIGMA,           "out.eni",  "out.enim",  nullptr,                                nullptr                                             },
+	{"-f",  Format::FAXMAN,           "out.fax",  "out.faxm",  &ClownLZSS::faxman_match_search,        ClownLZSS::FaxmanEstimateCompressedSize             },
+	{"-g",  Format::GBA,              "out.gba",  "out.gbam",  &ClownLZSS::gba_match_search,           ClownLZSS::GbaEstimateCompressedSize                },
+	{"-gv", Format::GBA_VRAM_SAFE,    "out.gba",  "out.gbam",  &ClownLZSS::gba_match_search,           ClownLZSS::GbaVramSafeEstimateCompressedSize        },
+	{"-k",  Format::KOSINSKI,         "out.kos",  "out.kosm",  &ClownLZSS::kosinski_match_search,      ClownLZSS::KosinskiEstimateCompressedSize           },
+	{"-kp", Format::KOSINSKIPLUS,     "out.kosp", "out.kospm", &ClownLZSS::kosinski_plus_match_search, ClownLZSS::KosinskiPlusEstimateCompressedSize       },
+	{"-ra", Format::RAGE,             "out.rage", "out.ragem", nullptr,                                nullptr                                             },
+	{"-r",  Format::ROCKET,           "out.rock", "out.rockm", nullptr,                                ClownLZSS::RocketEstimateCompressedSize             },
+	{"-s",  Format::SAXMAN,           "out.sax",  "out.saxm",  &ClownLZSS::saxman_match_search,        ClownLZSS::SaxmanEstimateCompressedSizeWithHeader   },
+	{"-sn", Format::SAXMAN_NO_HEADER, "out.sax",  "out.saxm",  &ClownLZSS::saxman_match_search,        ClownLZSS::SaxmanEstimateCompressedSizeWithoutHeader}
 });
 
 static void PrintUsage(void)
@@ -88,7 +112,9 @@ static void PrintUsage(void)
 	std::cout <<
 		"Clownacy's LZSS compression tool\n"
 		"\n"
-		"Usage: clownlzss [options] [in-filename] [out-filename]"
+		"Usage: clownlzss [options] [in-filename] [out-filename]\n"
+		"\n"
+		"If out-filename is '-', then the output is written to stdout.\n"
 		"\n"
 		"Options:\n"
 		"\n"
@@ -109,10 +135,53 @@ static void PrintUsage(void)
 		" Misc:\n"
 		"  -m[=MODULE_SIZE]  Compresses into modules\n"
 		"                    MODULE_SIZE controls the module size (defaults to 0x1000)\n"
+		"  -m=auto[:MAXIMUM] Compresses into modules of whichever size is smallest\n"
+		"                    MAXIMUM is the largest module size to try (defaults to 0x1000)\n"
 		"  -d     Decompress\n"
+		"  -verify           Decompresses the compressed data before it is written, to\n"
+		"                    make sure that it matches the original\n"
+		"  -auto[=FORMATS]   Compresses with every format, and keeps whichever is smallest\n"
+		"                    FORMATS is a comma-separated list of the formats to try (such\n"
+		"                    as 'k,kp,s'), and defaults to all of them\n"
+	#ifdef CLOWNLZSS_STATISTICS
+		"  -stats Prints statistics about how the data was compressed\n"
+	#endif
 	;
 }
 
+#ifdef CLOWNLZSS_STATISTICS
+static void PrintStatistics(std::ostream &stream, const ClownLZSS_Statistics &statistics)
+{
+	const auto PrintHistogram = [&](const char* const name, const std::size_t (&histogram)[CLOWNLZSS_STATISTICS_HISTOGRAM_SIZE])
+	{
+		stream << name << ":\n";
+
+		for (std::size_t i = 0; i < CLOWNLZSS_STATISTICS_HISTOGRAM_SIZE; ++i)
+			if (histogram[i] != 0)
+				stream << "  " << std::left << std::setw(8) << (std::to_string(std::size_t(1) << i) + (i == CLOWNLZSS_STATISTICS_HISTOGRAM_SIZE - 1 ? "+" : "")) << histogram[i] << '\n';
+	};
+
+	stream <<
+		"Input bytes:              " << statistics.input_bytes << "\n"
+		"Positions:                " << statistics.positions << "\n"
+		"Candidates walked:        " << statistics.candidates_walked << "\n"
+		"Bytes compared:           " << statistics.bytes_compared << "\n"
+		"Edges relaxed:            " << statistics.edges_relaxed << "\n"
+		"Match cost callbacks:     " << statistics.match_cost_callbacks << "\n"
+		"Extra matches callbacks:  " << statistics.extra_matches_callbacks << "\n"
+		"Literals:                 " << statistics.literals << "\n"
+		"Matches:                  " << statistics.matches << "\n"
+		"Peak memory:              " << statistics.peak_memory << " bytes\n"
+		"Initialisation time:      " << statistics.initialisation_time << " seconds\n"
+		"Search time:              " << statistics.search_time << " seconds\n"
+		"Backtrack time:           " << statistics.backtrack_time << " seconds\n"
+		"Encode time:              " << statistics.encode_time << " seconds\n";
+
+	PrintHistogram("Match lengths", statistics.match_length_histogram);
+	PrintHistogram("Match distances", statistics.match_distance_histogram);
+}
+#endif
+
 static auto FileToBuffer(const std::filesystem::path &path)
 {
 	std::vector<unsigned char> buffer(std::filesystem::file_size(path));
@@ -126,6 +195,808 @@ static auto FileToBuffer(const std::filesystem::path &path)
 	return buffer;
 }
 
+struct DecompressedSize
+{
+	std::size_t size;
+	// How far the decompressor may write past the end of the data.
+	std::size_t slack;
+};
+
+// Some formats store the size of the uncompressed data in their header.
+static std::optional<DecompressedSize> GetDecompressedSize(const Format format, const unsigned char* const data, const std::size_t size)
+{
+	switch (format)
+	{
+		case Format::GBA:
+		case Format::GBA_VRAM_SAFE:
+			if (size >= 4)
+				return DecompressedSize{ClownLZSS::GbaDecompressedSize(data), 18};
+
+			break;
+
+		case Format::ROCKET:
+			if (size >= 2)
+				return DecompressedSize{ClownLZSS::RocketDecompressedSize(data), 0x40};
+
+			break;
+
+		default:
+			break;
+	}
+
+	return std::nullopt;
+}
+
+// Once it is known where each module begins, all of them can be decompressed at the same time.
+// Returns nothing if the data is not valid.
+static std::optional<std::vector<unsigned char>> ModuledDecompressInParallel(const Format format, const unsigned char* const data, const std::size_t size)
+{
+	const unsigned char* const data_end = data + size;
+
+	std::vector<unsigned char> output;
+	bool success = false;
+
+	const auto Allocate = [&](const ClownLZSS::ModuleIndex &index)
+	{
+		output.resize(index.decompressed_size);
+		return output.data();
+	};
+
+	switch (format)
+	{
+		case Format::CHAMELEON:
+		{
+			const auto index = ClownLZSS::ModuledChameleonIndex(data, data_end);
+			success = index.has_value() && ClownLZSS::ModuledChameleonDecompressParallel(data, data_end, *index, Allocate(*index));
+			break;
+		}
+
+		case Format::COMPER:
+		{
+			const auto index = ClownLZSS::ModuledComperIndex(data, data_end);
+			success = index.has_value() && ClownLZSS::ModuledComperDecompressParallel(data, data_end, *index, Allocate(*index));
+			break;
+		}
+
+		case Format::ENIGMA:
+		{
+			const auto index = ClownLZSS::ModuledEnigmaIndex(data, data_end);
+			success = index.has_value() && ClownLZSS::ModuledEnigmaDecompressParallel(data, data_end, *index, Allocate(*index));
+			break;
+		}
+
+		case Format::FAXMAN:
+		{
+			const auto index = ClownLZSS::ModuledFaxmanIndex(data, data_end);
+			success = index.has_value() && ClownLZSS::ModuledFaxmanDecompressParallel(data, data_end, *index, Allocate(*index));
+			break;
+		}
+
+		case Format::GBA:
+		case Format::GBA_VRAM_SAFE:
+		{
+			const auto index = ClownLZSS::ModuledGbaIndex(data, data_end);
+			success = index.has_value() && ClownLZSS::ModuledGbaDecompressParallel(data, data_end, *index, Allocate(*index));
+			break;
+		}
+
+		case Format::KOSINSKI:
+		{
+			const auto index = ClownLZSS::ModuledKosinskiIndex(data, data_end);
+			success = index.has_value() && ClownLZSS::ModuledKosinskiDecompressParallel(data, data_end, *index, Allocate(*index));
+			break;
+		}
+
+		case Format::KOSINSKIPLUS:
+		{
+			const auto index = ClownLZSS::ModuledKosinskiPlusIndex(data, data_end);
+			success = index.has_value() && ClownLZSS::ModuledKosinskiPlusDecompressParallel(data, data_end, *index, Allocate(*index));
+			break;
+		}
+
+		case Format::RAGE:
+		{
+			const auto index = ClownLZSS::ModuledRageIndex(data, data_end);
+			success = index.has_value() && ClownLZSS::ModuledRageDecompressParallel(data, data_end, *index, Allocate(*index));
+			break;
+		}
+
+		case Format::ROCKET:
+		{
+			const auto index = ClownLZSS::ModuledRocketIndex(data, data_end);
+			success = index.has_value() && ClownLZSS::ModuledRocketDecompressParallel(data, data_end, *index, Allocate(*index));
+			break;
+		}
+
+		case Format::SAXMAN:
+		case Format::SAXMAN_NO_HEADER:
+		{
+			const auto index = ClownLZSS::ModuledSaxmanIndex(data, data_end);
+			success = index.has_value() && ClownLZSS::ModuledSaxmanDecompressParallel(data, data_end, *index, Allocate(*index));
+			break;
+		}
+	}
+
+	if (!success)
+		return std::nullopt;
+
+	return output;
+}
+
+// A read-only view of a file's contents. Where possible, the file is memory-mapped rather than copied into memory.
+class InputFile
+{
+private:
+	std::vector<unsigned char> buffer;
+	const unsigned char *pointer;
+	std::size_t file_size;
+#ifdef CLOWNLZSS_MMAP
+	void *mapping = MAP_FAILED;
+#endif
+
+public:
+	InputFile(const std::filesystem::path &path)
+	{
+	#ifdef CLOWNLZSS_MMAP
+		const int file_descriptor = open(path.c_str(), O_RDONLY);
+
+		if (file_descriptor != -1)
+		{
+			struct stat status;
+
+			// Empty files cannot be mapped.
+			if (fstat(file_descriptor, &status) == 0 && S_ISREG(status.st_mode) && status.st_size != 0)
+			{
+				mapping = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+
+				if (mapping != MAP_FAILED)
+				{
+					pointer = static_cast<const unsigned char*>(mapping);
+					file_size = status.st_size;
+				}
+			}
+
+			close(file_descriptor);
+
+			if (mapping != MAP_FAILED)
+				return;
+		}
+	#endif
+
+		buffer = FileToBuffer(path);
+		pointer = buffer.data();
+		file_size = buffer.size();
+	}
+
+	InputFile(const InputFile &other) = delete;
+	InputFile& operator=(const InputFile &other) = delete;
+
+	~InputFile()
+	{
+	#ifdef CLOWNLZSS_MMAP
+		if (mapping != MAP_FAILED)
+			munmap(mapping, file_size);
+	#endif
+	}
+
+	const unsigned char* data() const
+	{
+		return pointer;
+	}
+
+	std::size_t size() const
+	{
+		return file_size;
+	}
+};
+
+#ifdef CLOWNLZSS_MMAP
+// A writable memory-mapped file, for when the size of the output is known ahead of time.
+class MappedOutputFile
+{
+private:
+	int file_descriptor;
+	void *mapping = MAP_FAILED;
+	std::size_t capacity;
+
+	void Close()
+	{
+		if (mapping != MAP_FAILED)
+			munmap(mapping, capacity);
+
+		if (file_descriptor != -1)
+			close(file_descriptor);
+
+		mapping = MAP_FAILED;
+		file_descriptor = -1;
+	}
+
+public:
+	MappedOutputFile(const std::filesystem::path &path, const std::size_t capacity)
+		: capacity(capacity)
+	{
+		file_descriptor = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666);
+
+		if (file_descriptor == -1)
+			throw std::ios_base::failure("Could not open output file");
+
+		if (ftruncate(file_descriptor, capacity) != 0)
+		{
+			Close();
+			throw std::ios_base::failure("Could not resize output file");
+		}
+
+		mapping = mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, file_descriptor, 0);
+
+		if (mapping == MAP_FAILED)
+		{
+			Close();
+			throw std::ios_base::failure("Could not map output file");
+		}
+	}
+
+	MappedOutputFile(const MappedOutputFile &other) = delete;
+	MappedOutputFile& operator=(const MappedOutputFile &other) = delete;
+
+	~MappedOutputFile()
+	{
+		Close();
+	}
+
+	unsigned char* data() const
+	{
+		return static_cast<unsigned char*>(mapping);
+	}
+
+	// Unmaps the file and trims it to the amount of data that was actually written.
+	void Finish(const std::size_t size)
+	{
+		munmap(mapping, capacity);
+		mapping = MAP_FAILED;
+
+		const bool success = ftruncate(file_descriptor, size) == 0;
+
+		Close();
+
+		if (!success)
+			throw std::ios_base::failure("Could not resize output file");
+	}
+};
+#endif
+
+template<typename T>
+static bool CompressFile(const Format format, const bool moduled, const std::size_t module_size, const unsigned char* const data, const std::size_t size, T &&output)
+{
+	switch (format)
+	{
+		case Format::CHAMELEON:
+			if (moduled)
+				return ClownLZSS::ModuledChameleonCompress(data, size, output, module_size);
+			else
+				return ClownLZSS::ChameleonCompress(data, size, output);
+
+		case Format::COMPER:
+			if (moduled)
+				return ClownLZSS::ModuledComperCompress(data, size, output, module_size);
+			else
+				return ClownLZSS::ComperCompress(data, size, output);
+
+		case Format::ENIGMA:
+			if (moduled)
+				return ClownLZSS::ModuledEnigmaCompress(data, size, output, module_size);
+			else
+				return ClownLZSS::EnigmaCompress(data, size, output);
+
+		case Format::FAXMAN:
+			if (moduled)
+				return ClownLZSS::ModuledFaxmanCompress(data, size, output, module_size);
+			else
+				return ClownLZSS::FaxmanCompress(data, size, output);
+
+		case Format::GBA:
+			if (moduled)
+				return ClownLZSS::ModuledGbaCompress(data, size, output, module_size);
+			else
+				return ClownLZSS::GbaCompress(data, size, output);
+
+		case Format::GBA_VRAM_SAFE:
+			if (moduled)
+				return ClownLZSS::ModuledGbaVramSafeCompress(data, size, output, module_size);
+			else
+				return ClownLZSS::GbaVramSafeCompress(data, size, output);
+
+		case Format::KOSINSKI:
+			if (moduled)
+				return ClownLZSS::ModuledKosinskiCompress(data, size, output, module_size);
+			else
+				return ClownLZSS::KosinskiCompress(data, size, output);
+
+		case Format::KOSINSKIPLUS:
+			if (moduled)
+				return ClownLZSS::ModuledKosinskiPlusCompress(data, size, output, module_size);
+			else
+				return ClownLZSS::KosinskiPlusCompress(data, size, output);
+
+		case Format::RAGE:
+			if (moduled)
+				return ClownLZSS::ModuledRageCompress(data, size, output, module_size);
+			else
+				return ClownLZSS::RageCompress(data, size, output);
+
+		case Format::ROCKET:
+			if (moduled)
+				return ClownLZSS::ModuledRocketCompress(data, size, output, module_size);
+			else
+				return ClownLZSS::RocketCompress(data, size, output);
+
+		case Format::SAXMAN:
+			if (moduled)
+				return ClownLZSS::ModuledSaxmanCompress(data, size, output, module_size);
+			else
+				return ClownLZSS::SaxmanCompressWithHeader(data, size, output);
+
+		case Format::SAXMAN_NO_HEADER:
+			if (moduled)
+				return ClownLZSS::ModuledSaxmanCompress(data, size, output, module_size);
+			else
+				return ClownLZSS::SaxmanCompressWithoutHeader(data, size, output);
+	}
+
+	return false;
+}
+
+// Compresses using matches that were found ahead of time, so that several formats can share a single search.
+template<typename T>
+static bool CompressFileFromCandidates(const Format format, const ClownLZSS::MatchCandidates &candidates, T &&output)
+{
+	switch (format)
+	{
+		case Format::CHAMELEON:
+			return ClownLZSS::ChameleonCompress(candidates, output);
+
+		case Format::COMPER:
+			return ClownLZSS::ComperCompress(candidates, output);
+
+		case Format::FAXMAN:
+			return ClownLZSS::FaxmanCompress(candidates, output);
+
+		case Format::GBA:
+			return ClownLZSS::GbaCompress(candidates, output);
+
+		case Format::GBA_VRAM_SAFE:
+			return ClownLZSS::GbaVramSafeCompress(candidates, output);
+
+		case Format::KOSINSKI:
+			return ClownLZSS::KosinskiCompress(candidates, output);
+
+		case Format::KOSINSKIPLUS:
+			return ClownLZSS::KosinskiPlusCompress(candidates, output);
+
+		case Format::RAGE:
+			return ClownLZSS::RageCompress(candidates, output);
+
+		case Format::ROCKET:
+			return ClownLZSS::RocketCompress(candidates, output);
+
+		case Format::SAXMAN:
+			return ClownLZSS::SaxmanCompressWithHeader(candidates, output);
+
+		case Format::SAXMAN_NO_HEADER:
+			return ClownLZSS::SaxmanCompressWithoutHeader(candidates, output);
+
+		case Format::ENIGMA:
+			break;
+	}
+
+	return false;
+}
+
+// Some formats cannot represent certain inputs, so there is no point in trying them.
+static std::optional<std::string> GetReasonToSkip(const Format format, const bool moduled, const std::size_t size)
+{
+	switch (format)
+	{
+		case Format::COMPER:
+		case Format::ENIGMA:
+			if (size % 2 != 0)
+				return "input size is not a multiple of 2";
+
+			break;
+
+		case Format::GBA:
+		case Format::GBA_VRAM_SAFE:
+			if (!moduled && size > 0xFFFFFF)
+				return "input is too large for the 24-bit size header";
+
+			break;
+
+		case Format::ROCKET:
+			if (!moduled && size > 0xFFFF)
+				return "input is too large for the 16-bit size header";
+
+			break;
+
+		default:
+			break;
+	}
+
+	return std::nullopt;
+}
+
+struct Attempt
+{
+	const Mode *mode;
+	std::optional<std::string> reason_to_skip;
+	bool success = false;
+	std::string output;
+};
+
+// Rules out the formats which will clearly lose, without actually compressing the data with them.
+static void RuleOutWithEstimates(std::vector<Attempt> &attempts, const unsigned char* const data, const std::size_t size)
+{
+	// Smaller data is quick enough to compress that it is not worth the risk of ruling out the wrong format.
+	if (size < 0x10000)
+		return;
+
+	std::vector<std::optional<ClownLZSS::CompressedSizeEstimate>> estimates(attempts.size());
+	std::size_t best_highest_size = std::numeric_limits<std::size_t>::max();
+
+	for (std::size_t i = 0; i < attempts.size(); ++i)
+	{
+		const auto &attempt = attempts[i];
+		ClownLZSS::CompressedSizeEstimate estimate;
+
+		if (!attempt.reason_to_skip.has_value() && attempt.mode->estimate_compressed_size != nullptr && attempt.mode->estimate_compressed_size(data, size, estimate))
+		{
+			estimates[i] = estimate;
+			best_highest_size = std::min(best_highest_size, estimate.highest_size);
+		}
+	}
+
+	// The estimates are a little too high, by an amount that varies between formats, so leave some leeway.
+	const std::size_t threshold = best_highest_size + best_highest_size / 8;
+
+	for (std::size_t i = 0; i < attempts.size(); ++i)
+		if (estimates[i].has_value() && estimates[i]->lowest_size > threshold)
+			attempts[i].reason_to_skip = "estimated at " + std::to_string(estimates[i]->size) + " bytes";
+}
+
+// Compresses the data in every requested format at once, leaving the results in the attempts.
+static void CompressWithEveryFormat(std::vector<Attempt> &attempts, const bool moduled, const std::size_t module_size, const unsigned char* const data, const std::size_t size)
+{
+	// Formats with compatible match searches can share one, as the search is the most expensive part of compression.
+	// The modules of moduled compression are searched separately, so they do not benefit from this.
+	std::vector<Attempt*> sharing_attempts, other_attempts;
+	std::optional<ClownLZSS::MatchSearch> shared_search;
+
+	for (auto &attempt : attempts)
+	{
+		if (attempt.reason_to_skip.has_value())
+			continue;
+
+		if (!moduled && attempt.mode->match_search != nullptr)
+		{
+			sharing_attempts.push_back(&attempt);
+			shared_search = shared_search.has_value() ? ClownLZSS::CombineMatchSearches(*shared_search, *attempt.mode->match_search) : *attempt.mode->match_search;
+		}
+		else
+		{
+			other_attempts.push_back(&attempt);
+		}
+	}
+
+	// A single format has nobody to share with.
+	if (sharing_attempts.size() == 1)
+	{
+		other_attempts.push_back(sharing_attempts.front());
+		sharing_attempts.clear();
+	}
+
+	const auto Compress = [&](Attempt &attempt, const ClownLZSS::MatchCandidates* const candidates)
+	{
+		std::ostringstream output;
+
+		if (candidates != nullptr)
+			attempt.success = CompressFileFromCandidates(attempt.mode->format, *candidates, output);
+		else
+			attempt.success = CompressFile(attempt.mode->format, moduled, module_size, data, size, output);
+
+		attempt.output = std::move(output).str();
+	};
+
+	// The shared search runs alongside the formats which do not use it...
+	ClownLZSS::MatchCandidates candidates;
+	bool found_candidates = false;
+	const std::size_t total_searches = sharing_attempts.empty() ? 0 : 1;
+
+	ClownLZSS::Internal::RunInParallel(total_searches + other_attempts.size(), [&](const std::size_t index)
+	{
+		if (index < total_searches)
+			found_candidates = candidates.Find(*shared_search, data, size);
+		else
+			Compress(*other_attempts[index - total_searches], nullptr);
+	});
+
+	// ...and then the formats which do use it turn its results into their own output.
+	ClownLZSS::Internal::RunInParallel(sharing_attempts.size(), [&](const std::size_t index)
+	{
+		Compress(*sharing_attempts[index], found_candidates ? &candidates : nullptr);
+	});
+}
+
+// Moduled formats without a filler value can search the whole of the data once, and then share the results between modules.
+static const ClownLZSS::MatchSearch* GetModuledMatchSearch(const Format format)
+{
+	switch (format)
+	{
+		case Format::CHAMELEON:
+			return &ClownLZSS::chameleon_match_search;
+
+		case Format::COMPER:
+			return &ClownLZSS::comper_match_search;
+
+		case Format::FAXMAN:
+			return &ClownLZSS::faxman_match_search;
+
+		case Format::GBA:
+		case Format::GBA_VRAM_SAFE:
+			return &ClownLZSS::gba_match_search;
+
+		case Format::KOSINSKI:
+			return &ClownLZSS::kosinski_match_search;
+
+		case Format::KOSINSKIPLUS:
+			return &ClownLZSS::kosinski_plus_match_search;
+
+		case Format::RAGE:
+			return &ClownLZSS::rage_match_search;
+
+		case Format::SAXMAN:
+		case Format::SAXMAN_NO_HEADER:
+			return &ClownLZSS::saxman_match_search;
+
+		case Format::ENIGMA:
+		case Format::ROCKET:
+			break;
+	}
+
+	return nullptr;
+}
+
+template<typename T>
+static bool CompressFileModuledFromCandidates(const Format format, const ClownLZSS::MatchCandidates &candidates, const std::size_t module_size, T &&output)
+{
+	switch (format)
+	{
+		case Format::CHAMELEON:
+			return ClownLZSS::ModuledChameleonCompress(candidates, output, module_size);
+
+		case Format::COMPER:
+			return ClownLZSS::ModuledComperCompress(candidates, output, module_size);
+
+		case Format::FAXMAN:
+			return ClownLZSS::ModuledFaxmanCompress(candidates, output, module_size);
+
+		case Format::GBA:
+			return ClownLZSS::ModuledGbaCompress(candidates, output, module_size);
+
+		case Format::GBA_VRAM_SAFE:
+			return ClownLZSS::ModuledGbaVramSafeCompress(candidates, output, module_size);
+
+		case Format::KOSINSKI:
+			return ClownLZSS::ModuledKosinskiCompress(candidates, output, module_size);
+
+		case Format::KOSINSKIPLUS:
+			return ClownLZSS::ModuledKosinskiPlusCompress(candidates, output, module_size);
+
+		case Format::RAGE:
+			return ClownLZSS::ModuledRageCompress(candidates, output, module_size);
+
+		case Format::SAXMAN:
+		case Format::SAXMAN_NO_HEADER:
+			return ClownLZSS::ModuledSaxmanCompress(candidates, output, module_size);
+
+		case Format::ENIGMA:
+		case Format::ROCKET:
+			break;
+	}
+
+	return false;
+}
+
+struct ModuleSizeTrial
+{
+	std::size_t module_size;
+	bool success = false;
+	std::string output;
+};
+
+// The header of moduled data holds the number of whole modules above its bottom 12 bits, so it can only count so many.
+static bool ModuleCountFitsInHeader(const Format format, const std::size_t size, const std::size_t module_size)
+{
+	const unsigned int header_bits = format == Format::GBA || format == Format::GBA_VRAM_SAFE ? 32 : 16;
+
+	return size / module_size < std::size_t(1) << (header_bits - 12);
+}
+
+// Compresses the data with every module size that is no larger than the maximum, leaving the results in the trials.
+// Module sizes which would produce more modules than the header can count are left out.
+static std::vector<ModuleSizeTrial> CompressWithEveryModuleSize(const Format format, const std::size_t maximum_module_size, const unsigned char* const data, const std::size_t size)
+{
+	std::vector<ModuleSizeTrial> trials;
+
+	const auto AddTrial = [&](const std::size_t module_size)
+	{
+		if (ModuleCountFitsInHeader(format, size, module_size))
+			trials.push_back({module_size, false, {}});
+	};
+
+	for (std::size_t module_size = 0x10; module_size < 0x100 && module_size <= maximum_module_size; module_size *= 2)
+		AddTrial(module_size);
+
+	for (std::size_t module_size = 0x100; module_size <= maximum_module_size; module_size += 0x100)
+		AddTrial(module_size);
+
+	// Every module size shares one search of the whole of the data, instead of each module being searched again for every size.
+	const auto search = GetModuledMatchSearch(format);
+	ClownLZSS::MatchCandidates candidates;
+	const bool found_candidates = search != nullptr && size % search->bytes_per_value == 0 && candidates.Find(*search, data, size / search->bytes_per_value);
+
+	ClownLZSS::Internal::RunInParallel(trials.size(), [&](const std::size_t index)
+	{
+		auto &trial = trials[index];
+		std::ostringstream output;
+
+		if (found_candidates)
+			trial.success = CompressFileModuledFromCandidates(format, candidates, trial.module_size, output);
+		else
+			trial.success = CompressFile(format, true, trial.module_size, data, size, output);
+
+		trial.output = std::move(output).str();
+	});
+
+	return trials;
+}
+
+// Creates a decompressor for the given format, which accepts its input a piece at a time.
+static ClownLZSS::IncrementalDecompressor DecompressIncrementally(const Format format, const bool moduled, const std::size_t compressed_size)
+{
+	switch (format)
+	{
+		case Format::CHAMELEON:
+			return moduled ? ClownLZSS::ModuledChameleonDecompressIncrementally() : ClownLZSS::ChameleonDecompressIncrementally();
+
+		case Format::COMPER:
+			return moduled ? ClownLZSS::ModuledComperDecompressIncrementally() : ClownLZSS::ComperDecompressIncrementally();
+
+		case Format::ENIGMA:
+			return moduled ? ClownLZSS::ModuledEnigmaDecompressIncrementally() : ClownLZSS::EnigmaDecompressIncrementally();
+
+		case Format::FAXMAN:
+			return moduled ? ClownLZSS::ModuledFaxmanDecompressIncrementally() : ClownLZSS::FaxmanDecompressIncrementally();
+
+		case Format::GBA:
+		case Format::GBA_VRAM_SAFE:
+			return moduled ? ClownLZSS::ModuledGbaDecompressIncrementally() : ClownLZSS::GbaDecompressIncrementally();
+
+		case Format::KOSINSKI:
+			return moduled ? ClownLZSS::ModuledKosinskiDecompressIncrementally() : ClownLZSS::KosinskiDecompressIncrementally();
+
+		case Format::KOSINSKIPLUS:
+			return moduled ? ClownLZSS::ModuledKosinskiPlusDecompressIncrementally() : ClownLZSS::KosinskiPlusDecompressIncrementally();
+
+		case Format::RAGE:
+			return moduled ? ClownLZSS::ModuledRageDecompressIncrementally() : ClownLZSS::RageDecompressIncrementally();
+
+		case Format::ROCKET:
+			return moduled ? ClownLZSS::ModuledRocketDecompressIncrementally() : ClownLZSS::RocketDecompressIncrementally();
+
+		case Format::SAXMAN:
+			return moduled ? ClownLZSS::ModuledSaxmanDecompressIncrementally() : ClownLZSS::SaxmanDecompressIncrementally();
+
+		case Format::SAXMAN_NO_HEADER:
+			return moduled ? ClownLZSS::ModuledSaxmanDecompressIncrementally() : ClownLZSS::SaxmanDecompressIncrementally(compressed_size);
+	}
+
+	throw std::invalid_argument("Unknown format");
+}
+
+// A stream buffer which holds onto compressed data as it is written, while decompressing it on another thread
+// and comparing the result with the original data. This way, the data is checked while it is still being compressed.
+class Verifier : public std::streambuf
+{
+private:
+	const Format format;
+	const bool moduled;
+	const unsigned char* const data;
+	const std::size_t size;
+
+	std::string compressed;
+	// Headerless Saxman data cannot be decompressed until its size is known, so it has to wait until the end.
+	std::optional<ClownLZSS::IncrementalDecompressor> decompressor;
+	std::size_t total_matching = 0;
+	bool matches = true;
+
+	void Compare(const std::vector<unsigned char> &decompressed)
+	{
+		if (!matches)
+			return;
+
+		if (decompressed.size() > size - total_matching || !std::equal(decompressed.cbegin(), decompressed.cend(), data + total_matching))
+			matches = false;
+		else
+			total_matching += decompressed.size();
+	}
+
+	void Feed(const char* const bytes, const std::size_t total_bytes)
+	{
+		compressed.append(bytes, total_bytes);
+
+		if (decompressor.has_value())
+		{
+			decompressor->Feed(reinterpret_cast<const unsigned char*>(bytes), total_bytes);
+			Compare(decompressor->Drain());
+		}
+	}
+
+protected:
+	std::streamsize xsputn(const char* const bytes, const std::streamsize total_bytes) override
+	{
+		Feed(bytes, total_bytes);
+		return total_bytes;
+	}
+
+	int_type overflow(const int_type character) override
+	{
+		if (!traits_type::eq_int_type(character, traits_type::eof()))
+		{
+			const char byte = traits_type::to_char_type(character);
+			Feed(&byte, 1);
+		}
+
+		return traits_type::not_eof(character);
+	}
+
+public:
+	Verifier(const Format format, const bool moduled, const unsigned char* const data, const std::size_t size)
+		: format(format)
+		, moduled(moduled)
+		, data(data)
+		, size(size)
+	{
+		if (moduled || format != Format::SAXMAN_NO_HEADER)
+			decompressor.emplace(DecompressIncrementally(format, moduled, 0));
+	}
+
+	// Waits for the decompressor to catch up, and returns whether the data survived the round trip.
+	bool Finish()
+	{
+		if (!decompressor.has_value())
+		{
+			decompressor.emplace(DecompressIncrementally(format, moduled, compressed.size()));
+			decompressor->Feed(reinterpret_cast<const unsigned char*>(compressed.data()), compressed.size());
+		}
+
+		const bool success = decompressor->Finish();
+		Compare(decompressor->Drain());
+
+		return success && matches && total_matching == size;
+	}
+
+	const std::string& Compressed() const
+	{
+		return compressed;
+	}
+};
+
+// Checks data which has already been compressed in its entirety.
+static bool Verify(const Format format, const bool moduled, const unsigned char* const data, const std::size_t size, const std::string &compressed)
+{
+	Verifier verifier(format, moduled, data, size);
+	verifier.sputn(compressed.data(), compressed.size());
+	return verifier.Finish();
+}
+
 int main(int argc, char **argv)
 {
 	int exit_code = EXIT_SUCCESS;
@@ -133,8 +1004,15 @@ int main(int argc, char **argv)
 	const Mode *mode = NULL;
 	std::filesystem::path in_filename;
 	std::filesystem::path out_filename;
-	bool moduled = false, decompress = false;
+	bool moduled = false, decompress = false, verify = false;
+#ifdef CLOWNLZSS_STATISTICS
+	bool print_statistics = false;
+#endif
+	// The formats to choose between when '-auto' is used.
+	std::vector<const Mode*> automatic_modes;
 	std::size_t module_size = 0x1000;
+	// When set, the module size is chosen automatically, up to this size.
+	std::optional<std::size_t> maximum_module_size;
 
 	/* Skip past the executable name */
 	--argc;
@@ -145,7 +1023,7 @@ int main(int argc, char **argv)
 	{
 		const std::string_view arg(argv[i]);
 
-		if (arg[0] == '-')
+		if (arg[0] == '-' && arg.size() > 1)
 		{
 			if (arg == "-h" || arg == "--help")
 			{
@@ -157,7 +1035,24 @@ int main(int argc, char **argv)
 
 				const auto argument_position = arg.find_first_of('=');
 
-				if (argument_position != arg.npos)
+				if (argument_position != arg.npos && arg.substr(argument_position + 1).starts_with("auto"))
+				{
+					const auto parameter = arg.substr(argument_position + 1);
+					char *end = nullptr;
+
+					if (parameter == "auto")
+						maximum_module_size = 0x1000;
+					else if (parameter.starts_with("auto:"))
+						maximum_module_size = std::strtoul(&argv[i][argument_position + 1 + 5], &end, 0);
+
+					if (!maximum_module_size.has_value() || (end != nullptr && *end != '\0') || *maximum_module_size == 0 || *maximum_module_size > 0x1000)
+					{
+						std::cerr << "Invalid parameter to -m\n";
+						exit_code = EXIT_FAILURE;
+						break;
+					}
+				}
+				else if (argument_position != arg.npos)
 				{
 					char *end;
 					unsigned long result = std::strtoul(&argv[i][argument_position + 1], &end, 0);
@@ -181,6 +1076,54 @@ int main(int argc, char **argv)
 			{
 				decompress = true;
 			}
+			else if (arg == "-verify" || arg == "--verify")
+			{
+				verify = true;
+			}
+		#ifdef CLOWNLZSS_STATISTICS
+			else if (arg == "-stats")
+			{
+				print_statistics = true;
+			}
+		#endif
+			else if (arg == "-auto" || arg.starts_with("-auto="))
+			{
+				automatic_modes.clear();
+
+				if (arg == "-auto")
+				{
+					for (const auto &current_mode : modes)
+						automatic_modes.push_back(&current_mode);
+				}
+				else
+				{
+					for (auto list = arg.substr(6); exit_code != EXIT_FAILURE;)
+					{
+						const auto comma_position = list.find_first_of(',');
+						const auto name = list.substr(0, comma_position);
+
+						const auto current_mode = std::find_if(modes.cbegin(), modes.cend(), [&](const Mode &other_mode){return other_mode.command.substr(1) == name;});
+
+						if (current_mode == modes.cend())
+						{
+							std::cerr << "Invalid parameter to -auto\n";
+							exit_code = EXIT_FAILURE;
+						}
+						else if (std::find(automatic_modes.cbegin(), automatic_modes.cend(), &*current_mode) == automatic_modes.cend())
+						{
+							automatic_modes.push_back(&*current_mode);
+						}
+
+						if (comma_position == list.npos)
+							break;
+
+						list.remove_prefix(comma_position + 1);
+					}
+
+					if (exit_code == EXIT_FAILURE)
+						break;
+				}
+			}
 			else
 			{
 				for (const auto &current_mode : modes)
@@ -210,193 +1153,287 @@ int main(int argc, char **argv)
 			std::cerr << "Error: Input file not specified\n";
 			PrintUsage();
 		}
-		else if (mode == NULL)
+		else if (mode == NULL && automatic_modes.empty())
 		{
 			exit_code = EXIT_FAILURE;
 			std::cerr << "Error: Format not specified\n";
 			PrintUsage();
 		}
+		else if (!automatic_modes.empty() && decompress)
+		{
+			exit_code = EXIT_FAILURE;
+			std::cerr << "Error: -auto cannot be used with -d\n";
+		}
+		else if (maximum_module_size.has_value() && (decompress || !automatic_modes.empty()))
+		{
+			exit_code = EXIT_FAILURE;
+			std::cerr << "Error: -m=auto cannot be used with -d or -auto\n";
+		}
+		else if (verify && decompress)
+		{
+			exit_code = EXIT_FAILURE;
+			std::cerr << "Error: -verify cannot be used with -d\n";
+		}
+	#ifdef CLOWNLZSS_STATISTICS
+		// Statistics are gathered by whichever thread does the compressing, but these options spread the work across several.
+		else if (print_statistics && (decompress || !automatic_modes.empty() || maximum_module_size.has_value()))
+		{
+			exit_code = EXIT_FAILURE;
+			std::cerr << "Error: -stats cannot be used with -d, -auto, or -m=auto\n";
+		}
+	#endif
 		else
 		{
-			if (out_filename.empty())
+			// When choosing the format automatically, the default filename depends on which format is chosen.
+			if (out_filename.empty() && automatic_modes.empty())
 				out_filename = moduled ? mode->moduled_default_filename : mode->normal_default_filename;
 
 			try
 			{
-				std::ofstream out_file;
-				out_file.exceptions(out_file.badbit | out_file.eofbit | out_file.failbit);
-				out_file.open(out_filename, decompress ? out_file.trunc | out_file.in | out_file.out | out_file.binary : out_file.out | out_file.binary);
+				const InputFile in_file(in_filename);
 
-				if (decompress)
-				{
-					std::ifstream in_file;
-					in_file.exceptions(in_file.badbit | in_file.eofbit | in_file.failbit);
-					in_file.open(in_filename, in_file.in | in_file.binary);
+				// An output filename of '-' means standard output.
+				const bool output_to_stdout = out_filename == "-";
+
+				std::ofstream out_file_stream;
+				out_file_stream.exceptions(out_file_stream.badbit | out_file_stream.eofbit | out_file_stream.failbit);
 
-					switch (mode->format)
+				const auto OpenOutputStream = [&]() -> std::ostream&
+				{
+					if (output_to_stdout)
 					{
-						case Format::CHAMELEON:
-							if (moduled)
-								ClownLZSS::ModuledChameleonDecompress(in_file, out_file);
-							else
-								ClownLZSS::ChameleonDecompress(in_file, out_file);
-							break;
+					#ifdef _WIN32
+						_setmode(_fileno(stdout), _O_BINARY);
+					#endif
+						std::cout.exceptions(std::cout.badbit | std::cout.failbit);
+						return std::cout;
+					}
+					else
+					{
+						out_file_stream.open(out_filename, decompress ? out_file_stream.trunc | out_file_stream.in | out_file_stream.out | out_file_stream.binary : out_file_stream.out | out_file_stream.binary);
+						return out_file_stream;
+					}
+				};
 
-						case Format::COMPER:
-							if (moduled)
-								ClownLZSS::ModuledComperDecompress(in_file, out_file);
-							else
-								ClownLZSS::ComperDecompress(in_file, out_file);
-							break;
+			#ifdef CLOWNLZSS_STATISTICS
+				ClownLZSS_Statistics statistics = {};
+				std::optional<ClownLZSS::GatherStatistics> gather_statistics;
 
-						case Format::ENIGMA:
-							if (moduled)
-								ClownLZSS::ModuledEnigmaDecompress(in_file, out_file);
-							else
-								ClownLZSS::EnigmaDecompress(in_file, out_file);
-							break;
+				if (print_statistics)
+					gather_statistics.emplace(statistics);
+			#endif
 
-						case Format::FAXMAN:
-							if (moduled)
-								ClownLZSS::ModuledFaxmanDecompress(in_file, out_file);
-							else
-								ClownLZSS::FaxmanDecompress(in_file, out_file);
-							break;
+				if (!automatic_modes.empty())
+				{
+					std::vector<Attempt> attempts;
 
-						case Format::GBA:
-						case Format::GBA_VRAM_SAFE:
-							if (moduled)
-								ClownLZSS::ModuledGbaDecompress(in_file, out_file);
-							else
-								ClownLZSS::GbaDecompress(in_file, out_file);
-							break;
+					for (const auto current_mode : automatic_modes)
+						attempts.push_back({current_mode, GetReasonToSkip(current_mode->format, moduled, in_file.size()), false, {}});
 
-						case Format::KOSINSKI:
-							if (moduled)
-								ClownLZSS::ModuledKosinskiDecompress(in_file, out_file);
-							else
-								ClownLZSS::KosinskiDecompress(in_file, out_file);
-							break;
+					// The estimates are for unmoduled data only.
+					if (!moduled)
+						RuleOutWithEstimates(attempts, in_file.data(), in_file.size());
 
-						case Format::KOSINSKIPLUS:
-							if (moduled)
-								ClownLZSS::ModuledKosinskiPlusDecompress(in_file, out_file);
-							else
-								ClownLZSS::KosinskiPlusDecompress(in_file, out_file);
-							break;
+					CompressWithEveryFormat(attempts, moduled, module_size, in_file.data(), in_file.size());
 
-						case Format::RAGE:
-							if (moduled)
-								ClownLZSS::ModuledRageDecompress(in_file, out_file);
-							else
-								ClownLZSS::RageDecompress(in_file, out_file);
-							break;
+					// Ties go to whichever format was listed first.
+					const Attempt *smallest = nullptr;
 
-						case Format::ROCKET:
-							if (moduled)
-								ClownLZSS::ModuledRocketDecompress(in_file, out_file);
-							else
-								ClownLZSS::RocketDecompress(in_file, out_file);
-							break;
+					for (const auto &attempt : attempts)
+						if (attempt.success && (smallest == nullptr || attempt.output.size() < smallest->output.size()))
+							smallest = &attempt;
 
-						case Format::SAXMAN:
-							if (moduled)
-								ClownLZSS::ModuledSaxmanDecompress(in_file, out_file);
-							else
-								ClownLZSS::SaxmanDecompress(in_file, out_file);
-							break;
+					if (out_filename.empty() && smallest != nullptr)
+						out_filename = moduled ? smallest->mode->moduled_default_filename : smallest->mode->normal_default_filename;
 
-						case Format::SAXMAN_NO_HEADER:
-							if (moduled)
-								ClownLZSS::ModuledSaxmanDecompress(in_file, out_file);
-							else
-								ClownLZSS::SaxmanDecompress(in_file, out_file, std::filesystem::file_size(in_filename));
-							break;
+					// Keep the report out of the way of the compressed data.
+					std::ostream &report = output_to_stdout ? std::cerr : std::cout;
+
+					for (const auto &attempt : attempts)
+					{
+						report << "  " << std::left << std::setw(4) << attempt.mode->command;
+
+						if (attempt.reason_to_skip.has_value())
+							report << "skipped (" << *attempt.reason_to_skip << ")\n";
+						else if (!attempt.success)
+							report << "failed\n";
+						else
+							report << attempt.output.size() << " bytes\n";
+					}
+
+					if (smallest == nullptr)
+					{
+						exit_code = EXIT_FAILURE;
+						std::cerr << "Error: File could not be compressed\n";
+					}
+					else if (verify && !Verify(smallest->mode->format, moduled, in_file.data(), in_file.size(), smallest->output))
+					{
+						exit_code = EXIT_FAILURE;
+						std::cerr << "Error: Compressed data did not decompress back into the original data\n";
+					}
+					else
+					{
+						report << "Chose " << smallest->mode->command << '\n';
+						OpenOutputStream().write(smallest->output.data(), smallest->output.size());
 					}
 				}
-				else
+				else if (decompress)
 				{
-					const bool success = [&]() -> bool
+					if (moduled)
 					{
-						const auto file_buffer = FileToBuffer(in_filename);
+						const auto output = ModuledDecompressInParallel(mode->format, in_file.data(), in_file.size());
 
-						switch (mode->format)
+						if (output.has_value())
+						{
+							OpenOutputStream().write(reinterpret_cast<const char*>(output->data()), output->size());
+						}
+						else
 						{
-							case Format::CHAMELEON:
-								if (moduled)
-									return ClownLZSS::ModuledChameleonCompress(file_buffer.data(), file_buffer.size(), out_file, module_size);
-								else
-									return ClownLZSS::ChameleonCompress(file_buffer.data(), file_buffer.size(), out_file);
-
-							case Format::COMPER:
-								if (moduled)
-									return ClownLZSS::ModuledComperCompress(file_buffer.data(), file_buffer.size(), out_file, module_size);
-								else
-									return ClownLZSS::ComperCompress(file_buffer.data(), file_buffer.size(), out_file);
-
-							case Format::ENIGMA:
-								if (moduled)
-									return ClownLZSS::ModuledEnigmaCompress(file_buffer.data(), file_buffer.size(), out_file, module_size);
-								else
-									return ClownLZSS::EnigmaCompress(file_buffer.data(), file_buffer.size(), out_file);
-
-							case Format::FAXMAN:
-								if (moduled)
-									return ClownLZSS::ModuledFaxmanCompress(file_buffer.data(), file_buffer.size(), out_file, module_size);
-								else
-									return ClownLZSS::FaxmanCompress(file_buffer.data(), file_buffer.size(), out_file);
-
-							case Format::GBA:
-								if (moduled)
-									return ClownLZSS::ModuledGbaCompress(file_buffer.data(), file_buffer.size(), out_file, module_size);
-								else
-									return ClownLZSS::GbaCompress(file_buffer.data(), file_buffer.size(), out_file);
-
-							case Format::GBA_VRAM_SAFE:
-								if (moduled)
-									return ClownLZSS::ModuledGbaVramSafeCompress(file_buffer.data(), file_buffer.size(), out_file, module_size);
-								else
-									return ClownLZSS::GbaVramSafeCompress(file_buffer.data(), file_buffer.size(), out_file);
-
-							case Format::KOSINSKI:
-								if (moduled)
-									return ClownLZSS::ModuledKosinskiCompress(file_buffer.data(), file_buffer.size(), out_file, module_size);
-								else
-									return ClownLZSS::KosinskiCompress(file_buffer.data(), file_buffer.size(), out_file);
-
-							case Format::KOSINSKIPLUS:
-								if (moduled)
-									return ClownLZSS::ModuledKosinskiPlusCompress(file_buffer.data(), file_buffer.size(), out_file, module_size);
-								else
-									return ClownLZSS::KosinskiPlusCompress(file_buffer.data(), file_buffer.size(), out_file);
-
-							case Format::RAGE:
-								if (moduled)
-									return ClownLZSS::ModuledRageCompress(file_buffer.data(), file_buffer.size(), out_file, module_size);
-								else
-									return ClownLZSS::RageCompress(file_buffer.data(), file_buffer.size(), out_file);
-
-							case Format::ROCKET:
-								if (moduled)
-									return ClownLZSS::ModuledRocketCompress(file_buffer.data(), file_buffer.size(), out_file, module_size);
-								else
-									return ClownLZSS::RocketCompress(file_buffer.data(), file_buffer.size(), out_file);
-
-							case Format::SAXMAN:
-								if (moduled)
-									return ClownLZSS::ModuledSaxmanCompress(file_buffer.data(), file_buffer.size(), out_file, module_size);
-								else
-									return ClownLZSS::SaxmanCompressWithHeader(file_buffer.data(), file_buffer.size(), out_file);
-
-							case Format::SAXMAN_NO_HEADER:
-								if (moduled)
-									return ClownLZSS::ModuledSaxmanCompress(file_buffer.data(), file_buffer.size(), out_file, module_size);
-								else
-									return ClownLZSS::SaxmanCompressWithoutHeader(file_buffer.data(), file_buffer.size(), out_file);
+							exit_code = EXIT_FAILURE;
+							std::cerr << "Error: File is not valid compressed data\n";
 						}
+					}
+					else
+					{
+						// The data cannot be trusted, so the decompressors are kept within the bounds of both the input and the output.
+						const unsigned char* const data_end = in_file.data() + in_file.size();
+
+						const auto Decompress = [&]<typename... T>(T &&...output)
+						{
+							switch (mode->format)
+							{
+								case Format::CHAMELEON:
+									return ClownLZSS::ChameleonDecompress(in_file.data(), data_end, std::forward<T>(output)...);
+
+								case Format::COMPER:
+									return ClownLZSS::ComperDecompress(in_file.data(), data_end, std::forward<T>(output)...);
+
+								case Format::ENIGMA:
+									return ClownLZSS::EnigmaDecompress(in_file.data(), data_end, std::forward<T>(output)...);
 
-						return false;
-					}();
+								case Format::FAXMAN:
+									return ClownLZSS::FaxmanDecompress(in_file.data(), data_end, std::forward<T>(output)...);
+
+								case Format::GBA:
+								case Format::GBA_VRAM_SAFE:
+									return ClownLZSS::GbaDecompress(in_file.data(), data_end, std::forward<T>(output)...);
+
+								case Format::KOSINSKI:
+									return ClownLZSS::KosinskiDecompress(in_file.data(), data_end, std::forward<T>(output)...);
+
+								case Format::KOSINSKIPLUS:
+									return ClownLZSS::KosinskiPlusDecompress(in_file.data(), data_end, std::forward<T>(output)...);
+
+								case Format::RAGE:
+									return ClownLZSS::RageDecompress(in_file.data(), data_end, std::forward<T>(output)...);
+
+								case Format::ROCKET:
+									return ClownLZSS::RocketDecompress(in_file.data(), data_end, std::forward<T>(output)...);
+
+								case Format::SAXMAN:
+									return ClownLZSS::SaxmanDecompress(in_file.data(), data_end, std::forward<T>(output)...);
+
+								case Format::SAXMAN_NO_HEADER:
+									return ClownLZSS::SaxmanDecompress(in_file.data(), data_end, std::forward<T>(output)..., in_file.size());
+							}
+
+							return false;
+						};
+
+						const auto decompressed_size = GetDecompressedSize(mode->format, in_file.data(), in_file.size());
+						bool success;
+
+				#ifdef CLOWNLZSS_MMAP
+						// When the size of the output is known, it can be decompressed straight into a memory-mapped file.
+						if (decompressed_size.has_value() && !output_to_stdout && (!std::filesystem::exists(out_filename) || std::filesystem::is_regular_file(out_filename)))
+						{
+							const std::size_t capacity = decompressed_size->size + decompressed_size->slack;
+							MappedOutputFile out_file(out_filename, capacity);
+							success = Decompress(out_file.data(), out_file.data() + capacity);
+							out_file.Finish(success ? decompressed_size->size : 0);
+						}
+						else
+				#endif
+						{
+							// Blocks of data are written straight out of the decompressor's dictionary.
+							std::ostream &stream = OpenOutputStream();
+
+							success = Decompress([&stream](const unsigned char* const data, const std::size_t size)
+							{
+								stream.write(reinterpret_cast<const char*>(data), size);
+							});
+						}
+
+						if (!success)
+						{
+							exit_code = EXIT_FAILURE;
+							std::cerr << "Error: File is not valid compressed data\n";
+						}
+					}
+				}
+				else if (maximum_module_size.has_value())
+				{
+					const auto trials = CompressWithEveryModuleSize(mode->format, *maximum_module_size, in_file.data(), in_file.size());
+
+					// Ties go to the smaller module size, as it needs less memory to decompress.
+					const ModuleSizeTrial *smallest = nullptr;
+
+					for (const auto &trial : trials)
+						if (trial.success && (smallest == nullptr || trial.output.size() < smallest->output.size()))
+							smallest = &trial;
+
+					std::ostream &report = output_to_stdout ? std::cerr : std::cout;
+
+					for (const auto &trial : trials)
+					{
+						report << "  0x" << std::left << std::setw(5) << std::hex << trial.module_size << std::dec;
+
+						if (trial.success)
+							report << trial.output.size() << " bytes\n";
+						else
+							report << "failed\n";
+					}
+
+					if (smallest == nullptr)
+					{
+						exit_code = EXIT_FAILURE;
+						std::cerr << "Error: File could not be compressed\n";
+					}
+					else if (verify && !Verify(mode->format, true, in_file.data(), in_file.size(), smallest->output))
+					{
+						exit_code = EXIT_FAILURE;
+						std::cerr << "Error: Compressed data did not decompress back into the original data\n";
+					}
+					else
+					{
+						report << "Chose a module size of 0x" << std::hex << smallest->module_size << std::dec << '\n';
+						OpenOutputStream().write(smallest->output.data(), smallest->output.size());
+					}
+				}
+				else if (verify)
+				{
+					// The compressed data is decompressed as it is produced, and is only written once it has been checked.
+					Verifier verifier(mode->format, moduled, in_file.data(), in_file.size());
+					std::ostream stream(&verifier);
+
+					if (!CompressFile(mode->format, moduled, module_size, in_file.data(), in_file.size(), stream))
+					{
+						exit_code = EXIT_FAILURE;
+						std::cerr << "Error: File could not be compressed\n";
+					}
+					else if (!verifier.Finish())
+					{
+						exit_code = EXIT_FAILURE;
+						std::cerr << "Error: Compressed data did not decompress back into the original data\n";
+					}
+					else
+					{
+						OpenOutputStream().write(verifier.Compressed().data(), verifier.Compressed().size());
+					}
+				}
+				else
+				{
+					const bool success = CompressFile(mode->format, moduled, module_size, in_file.data(), in_file.size(), OpenOutputStream());
 
 					if (!success)
 					{
@@ -404,12 +1441,22 @@ int main(int argc, char **argv)
 						std::cerr << "Error: File could not be compressed\n";
 					}
 				}
+
+			#ifdef CLOWNLZSS_STATISTICS
+				if (print_statistics && exit_code != EXIT_FAILURE)
+					PrintStatistics(output_to_stdout ? std::cerr : std::cout, statistics);
+			#endif
 			}
 			catch (const std::ios_base::failure& fail)
 			{
 				exit_code = EXIT_FAILURE;
 				std::cerr << "Error: File IO failure with description '" << fail.what() << "'\n";
 			}
+			catch (const std::filesystem::filesystem_error& fail)
+			{
+				exit_code = EXIT_FAILURE;
+				std::cerr << "Error: Filesystem failure with description '" << fail.what() << "'\n";
+			}
 		}
 	}
 
@@ -0,0 +1,12 @@
+# Runs clownlzss with its output directed to stdout, and compares what it writes against a file.
+execute_process(COMMAND "${CLOWNLZSS}" ${ARGUMENTS} "${INPUT}" - OUTPUT_FILE "${OUTPUT}" RESULT_VARIABLE result)
+
+if(NOT result EQUAL 0)
+	message(FATAL_ERROR "clownlzss failed with '${result}'")
+endif()
+
+execute_process(COMMAND "${CMAKE_COMMAND}" -E compare_files "${EXPECTED}" "${OUTPUT}" RESULT_VARIABLE result)
+
+if(NOT result EQUAL 0)
+	message(FATAL_ERROR "'${OUTPUT}' does not match '${EXPECTED}'")
+endif()
@@ -0,0 +1,6 @@
+# Runs clownlzss on data that it should reject, and checks that it fails cleanly rather than crashing or succeeding.
+execute_process(COMMAND "${CLOWNLZSS}" ${ARGUMENTS} "${INPUT}" "${OUTPUT}" OUTPUT_QUIET RESULT_VARIABLE result)
+
+if(NOT result EQUAL 1)
+	message(FATAL_ERROR "clownlzss exited with '${result}' instead of failing")
+endif()
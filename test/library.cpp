@@ -0,0 +1,276 @@
+// Tests for the parts of the library which the command-line tool does not use.
+// Usage: clownlzss-library-test <test name> <path to the 'test' directory>
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <ranges>
+#include <sstream>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "../compressors/saxman.h"
+#include "../decompressors/chameleon.h"
+#include "../decompressors/kosinski.h"
+#include "../decompressors/kosinskiplus.h"
+#include "../decompressors/rocket.h"
+#include "../decompressors/saxman.h"
+
+static std::filesystem::path test_directory;
+
+static std::vector<unsigned char> LoadFile(const std::filesystem::path &path)
+{
+	std::ifstream file(test_directory / path, std::ios::binary);
+	return std::vector<unsigned char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+static bool Check(const bool condition, const std::string_view message)
+{
+	if (!condition)
+		std::cerr << "Error: " << message << '\n';
+
+	return condition;
+}
+
+// Input is fed one byte at a time, which is the worst case for the decompressor running out of input mid-read.
+static bool TestIncremental()
+{
+	const auto TestFormat = [](const char* const format, ClownLZSS::IncrementalDecompressor decompressor)
+	{
+		const auto compressed = LoadFile(std::filesystem::path("chameleon_code") / format);
+		const auto uncompressed = LoadFile("chameleon_code/uncompressed");
+
+		std::vector<unsigned char> output;
+
+		for (const auto &byte : compressed)
+		{
+			decompressor.Feed(&byte, 1);
+
+			const auto drained = decompressor.Drain();
+			output.insert(output.end(), drained.begin(), drained.end());
+		}
+
+		const bool success = decompressor.Finish();
+
+		const auto drained = decompressor.Drain();
+		output.insert(output.end(), drained.begin(), drained.end());
+
+		return Check(success, "Incremental decompression failed") && Check(output == uncompressed, "Incremental decompression produced the wrong data");
+	};
+
+	return TestFormat("kosinski", ClownLZSS::KosinskiDecompressIncrementally())
+		&& TestFormat("kosinskiplus_moduled", ClownLZSS::ModuledKosinskiPlusDecompressIncrementally())
+		&& TestFormat("saxman", ClownLZSS::SaxmanDecompressIncrementally());
+}
+
+static bool TestIncrementalTruncated()
+{
+	const auto compressed = LoadFile("chameleon_code/kosinski");
+
+	auto decompressor = ClownLZSS::KosinskiDecompressIncrementally();
+	decompressor.Feed(compressed.data(), compressed.size() / 2);
+
+	// This claims to have one byte of descriptor fields, but needs more than that.
+	const unsigned char malformed[] = {0x00, 0x01, 0xFF, 'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J'};
+
+	auto malformed_decompressor = ClownLZSS::ChameleonDecompressIncrementally();
+	malformed_decompressor.Feed(malformed, std::size(malformed));
+
+	return Check(!decompressor.Finish(), "Incremental decompression of truncated data succeeded")
+		&& Check(!malformed_decompressor.Finish(), "Incremental decompression of malformed data succeeded");
+}
+
+// A decompressor which is destroyed while still waiting for input must stop rather than hang.
+static bool TestIncrementalAbandoned()
+{
+	const auto compressed = LoadFile("chameleon_code/kosinski");
+
+	{
+		auto decompressor = ClownLZSS::KosinskiDecompressIncrementally();
+	}
+
+	{
+		auto decompressor = ClownLZSS::KosinskiDecompressIncrementally();
+		decompressor.Feed(compressed.data(), compressed.size() / 2);
+	}
+
+	return true;
+}
+
+// Each decompressor can only be blocked on one side: an incremental decompressor's output is kept until it is drained,
+// so it only ever waits for input, while a view's input is all there, so it only ever waits for the reader to take its output.
+// Either way, destroying the object must free the decompressor, rather than leave it waiting forever.
+static bool TestAbandonedWhileBlocked()
+{
+	const auto WaitFor = [](const std::atomic<bool> &flag)
+	{
+		while (!flag)
+			std::this_thread::yield();
+	};
+
+	std::atomic<bool> waiting_for_input = false;
+	bool saw_end_of_input = false;
+
+	{
+		ClownLZSS::IncrementalDecompressor decompressor([&](std::istream &input, [[maybe_unused]] auto &output)
+		{
+			input.get();
+			waiting_for_input = true;
+			// Only one byte has been fed, so this waits.
+			saw_end_of_input = input.get() == EOF;
+		});
+
+		const unsigned char byte = 0;
+		decompressor.Feed(&byte, 1);
+		WaitFor(waiting_for_input);
+	}
+
+	std::atomic<bool> waiting_for_reader = false;
+	bool gave_everything = false;
+
+	{
+		ClownLZSS::DecompressionView view([&](auto &sink)
+		{
+			const unsigned char byte = 0;
+			sink(&byte, 1);
+			waiting_for_reader = true;
+			// Nothing has been read, so the first byte is still pending, and this waits.
+			sink(&byte, 1);
+			gave_everything = true;
+		});
+
+		WaitFor(waiting_for_reader);
+	}
+
+	return Check(saw_end_of_input, "An abandoned incremental decompressor was not given the end of the input")
+		&& Check(!gave_everything, "An abandoned view's decompressor was allowed to carry on");
+}
+
+static bool TestLazy()
+{
+	const auto compressed = LoadFile("executable/kosinski");
+	const auto uncompressed = LoadFile("executable/uncompressed");
+
+	std::vector<unsigned char> whole;
+	std::ranges::copy(ClownLZSS::KosinskiDecompressLazily(compressed.data()), std::back_inserter(whole));
+
+	// Far less than the data is read, so the decompressor is left waiting to hand over more when the view is destroyed.
+	std::vector<unsigned char> start;
+	std::ranges::copy(ClownLZSS::KosinskiDecompressLazily(compressed.data()) | std::views::take(100), std::back_inserter(start));
+
+	{
+		auto unread = ClownLZSS::KosinskiDecompressLazily(compressed.data());
+	}
+
+	return Check(whole == uncompressed, "Lazy decompression produced the wrong data")
+		&& Check(std::ranges::equal(start, uncompressed | std::views::take(100)), "Lazy decompression with 'std::views::take' produced the wrong data");
+}
+
+static bool TestRange()
+{
+	const auto compressed = LoadFile("clone_driver_v2_dac_driver/kosinskiplus_moduled");
+	const auto uncompressed = LoadFile("clone_driver_v2_dac_driver/uncompressed");
+
+	const auto index = ClownLZSS::ModuledKosinskiPlusIndex(compressed.data(), compressed.data() + compressed.size());
+
+	if (!Check(index.has_value(), "Indexing moduled data failed"))
+		return false;
+
+	const std::size_t size = index->decompressed_size;
+	std::vector<unsigned char> middle(size / 2);
+
+	const auto DecompressRange = [&](const std::size_t offset, const std::size_t length)
+	{
+		return ClownLZSS::ModuledKosinskiPlusDecompressRange(compressed.data(), compressed.data() + compressed.size(), *index, middle.data(), offset, length);
+	};
+
+	return Check(DecompressRange(size / 4, middle.size()), "Decompressing a range failed")
+		&& Check(std::ranges::equal(middle, uncompressed | std::views::drop(size / 4) | std::views::take(middle.size())), "Decompressing a range produced the wrong data")
+		&& Check(DecompressRange(size, 0), "Decompressing an empty range at the end failed")
+		&& Check(!DecompressRange(size + 1, 0), "Decompressing a range after the end succeeded")
+		&& Check(!DecompressRange(size - 1, 2), "Decompressing a range which goes past the end succeeded")
+		&& Check(!DecompressRange(1, static_cast<std::size_t>(-1)), "Decompressing a range whose end overflows succeeded");
+}
+
+// The sink's dictionary must start out holding the format's filler value, just as the other outputs behave as if it does.
+static bool TestSink()
+{
+	const auto DecompressToSink = [](const auto &decompress)
+	{
+		std::vector<unsigned char> output;
+
+		decompress([&output](const unsigned char* const data, const std::size_t size)
+		{
+			output.insert(output.end(), data, data + size);
+		});
+
+		return output;
+	};
+
+	// Saxman compresses runs of zeroes at the start of the data as matches from before the start.
+	std::vector<unsigned char> saxman_uncompressed(0x40, 0);
+
+	for (unsigned int i = 0; i < 0x100; ++i)
+		saxman_uncompressed.push_back(i * 7);
+
+	std::stringstream saxman_compressed;
+	ClownLZSS::SaxmanCompressWithHeader(saxman_uncompressed.data(), saxman_uncompressed.size(), saxman_compressed);
+
+	const auto saxman_output = DecompressToSink([&](auto &&sink)
+	{
+		ClownLZSS::SaxmanDecompress(saxman_compressed, sink);
+	});
+
+	// Rocket's compressor never refers to before the start of the data, so this is made by hand:
+	// a match of 0x10 bytes from 0x100 bytes before the start, which should be spaces, followed by two literals.
+	const unsigned char rocket_compressed[] = {0x00, 0x12, 0x00, 0x05, 0x06, 0x3E, 0xC0, 'A', 'B'};
+	const std::string_view rocket_uncompressed = "                AB";
+
+	const auto rocket_output = DecompressToSink([&](auto &&sink)
+	{
+		ClownLZSS::RocketDecompress(rocket_compressed, sink);
+	});
+
+	std::vector<unsigned char> rocket_random_access_output(rocket_uncompressed.size() + 0x40);
+	ClownLZSS::RocketDecompress(rocket_compressed, rocket_random_access_output.data());
+
+	return Check(saxman_output == saxman_uncompressed, "Saxman decompression to a sink produced the wrong data")
+		&& Check(std::ranges::equal(rocket_output, rocket_uncompressed), "Rocket decompression to a sink produced the wrong data")
+		&& Check(std::ranges::equal(rocket_random_access_output | std::views::take(rocket_uncompressed.size()), rocket_uncompressed), "Rocket decompression to memory produced the wrong data");
+}
+
+int main(int argc, char **argv)
+{
+	if (argc != 3)
+	{
+		std::cerr << "Usage: clownlzss-library-test <test name> <path to the 'test' directory>\n";
+		return EXIT_FAILURE;
+	}
+
+	const std::string_view name = argv[1];
+	test_directory = argv[2];
+
+	const std::pair<std::string_view, std::function<bool()>> tests[] = {
+		{"incremental", TestIncremental},
+		{"incremental_truncated", TestIncrementalTruncated},
+		{"incremental_abandoned", TestIncrementalAbandoned},
+		{"abandoned_while_blocked", TestAbandonedWhileBlocked},
+		{"lazy", TestLazy},
+		{"range", TestRange},
+		{"sink", TestSink},
+	};
+
+	for (const auto &test : tests)
+		if (test.first == name)
+			return test.second() ? EXIT_SUCCESS : EXIT_FAILURE;
+
+	std::cerr << "Error: Unknown test '" << name << "'\n";
+	return EXIT_FAILURE;
+}
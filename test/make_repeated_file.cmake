@@ -0,0 +1,11 @@
+# Writes a file of SIZE bytes which are all the letter 'A', for tests which need more data than the test files hold.
+set(contents "A")
+string(LENGTH "${contents}" length)
+
+while(length LESS SIZE)
+	set(contents "${contents}${contents}")
+	string(LENGTH "${contents}" length)
+endwhile()
+
+string(SUBSTRING "${contents}" 0 ${SIZE} contents)
+file(WRITE "${OUTPUT}" "${contents}")